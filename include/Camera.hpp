@@ -25,11 +25,11 @@ namespace renderer {
 
         Point3 cameraCenter;
         Point3 cameraTarget;                    //相机放置在cameraCenter，看向cameraTarget，此两点间距为焦距
-        double horizontalFOV;                   //水平方向的视角，构造时单位为角度，决定视口宽度
+        Real horizontalFOV;                     //水平方向的视角，构造时单位为角度，决定视口宽度
 
         //视口属性
-        double viewPortWidth;
-        double viewPortHeight;
+        Real viewPortWidth;
+        Real viewPortHeight;
 
         /*
          * 视口平面的基向量，用于定位视口
@@ -44,29 +44,41 @@ namespace renderer {
         Point3 pixelOrigin;                     //第一个像素的空间坐标
 
         //采样属性
-        double focusDiskRadius;                 //光线虚化强度，采样平面的圆盘半径
-        double focusDistance;                   //焦距
+        Real focusDiskRadius;                   //光线虚化强度，采样平面的圆盘半径
+        Real focusDistance;                     //焦距
 
         Range shutterRange;                     //相机快门的开启时间段
 
         Uint32 sampleCount;                     //SSAA：每像素采样数
-        double sampleRange;                     //SSAA：采样偏移半径
+        Real sampleRange;                       //SSAA：采样偏移半径
         size_t sqrtSampleCount;
-        double reciprocalSqrtSampleCount;
+        Real reciprocalSqrtSampleCount;
 
         Uint32 rayTraceDepth;                   //光线追踪深度
+        Uint32 russianRouletteDepth;            //光路反射次数达到此值后使用俄罗斯轮盘赌随机终止光路，不小于rayTraceDepth时不启用
+
+        //并行渲染属性
+        Uint32 tileSize;                        //图块边长（像素），每个图块作为一个渲染任务
+        Uint32 threadCount;                     //渲染线程数，默认为硬件线程数
+        Uint64 seed;                            //随机数种子，相同种子的渲染结果与线程数无关
+        SamplerType samplerType;                //采样器类型，默认为Owen扰乱的Sobol序列
+
+        //渐进式渲染属性：每一轮为每个像素增加samplesPerPass个采样并累加，直到达到采样数或时间上限
+        Uint32 samplesPerPass;                  //每轮每像素采样数，为0时一轮完成全部采样
+        Uint32 denoisePassInterval;             //有预览窗口时每隔多少轮降噪并刷新预览（不影响帧缓冲区），为0时只在渲染结束后降噪
+        Uint32 timeLimit;                       //渲染时间上限（毫秒），在每轮结束时检查，为0时不限制
+
+        //自适应采样属性：adaptiveThreshold大于0时启用，每轮只为尚未收敛的像素增加采样
+        double adaptiveThreshold;               //像素收敛的误差阈值，误差为显示空间（伽马校正后）的标准误差
+        Uint32 adaptiveMinSampleCount;          //判断收敛前每像素的最小采样数
+        Uint32 adaptiveMaxSampleCount;          //每像素的最大采样数，为0时使用sqrtSampleCount^2
 
         //降噪器
         Denoiser denoiser;
 
-        //单个像素数据缓冲区
-        std::vector<Color3> albedoList;
-        std::vector<Vec3> normalList;
-        std::vector<bool> isRecordList;
-
         Camera(Uint32 windowWidth, Uint32 windowHeight, const Color3 & backgroundColor,
-                       const Point3 & center, const Point3 & target, double fov, double focusDiskRadius,
-                       const Range & shutterRange, Uint32 sampleCount, double sampleRange,
+                       const Point3 & center, const Point3 & target, Real fov, Real focusDiskRadius,
+                       const Range & shutterRange, Uint32 sampleCount, Real sampleRange,
                        Uint32 rayTraceDepth, const Vec3 & upDirection);
 
         std::string toString() const;
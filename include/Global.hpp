@@ -11,7 +11,6 @@
 #include <memory>
 #include <cmath>
 #include <cstring>
-#include <random>
 #include <algorithm>
 #include <limits>
 #include <array>
@@ -21,6 +20,18 @@
 #undef NULL
 
 namespace renderer {
+    /*
+     * 数学核心（向量、点、颜色、光线、区间、包围盒、图元和材质）使用的标量类型
+     * 默认为double；定义RENDERER_FLOAT_PRECISION时（CMake选项RENDERER_ENABLE_FLOAT_PRECISION）为float，
+     * 数据量减半，SIMD寄存器可以容纳的分量数加倍，与GPU的单精度运算一致
+     * 随机数生成器、采样器、BVH构建的SAH代价和像素统计量不受此类型影响
+     */
+#ifdef RENDERER_FLOAT_PRECISION
+    typedef float Real;
+#else
+    typedef double Real;
+#endif
+
     // ====== 数值常量 ======
     constexpr double FLOAT_VALUE_ZERO_EPSILON = 1e-5;
     constexpr double INFINITY = std::numeric_limits<double>::infinity();
@@ -36,24 +47,65 @@ namespace renderer {
         return radian * 180.0 / PI;
     }
 
-    //生成一个[0, 1)之间的浮点随机数
-    inline double randomDouble() {
-        static std::random_device rd; //需要初始化随机设备，让每次运行都能生成不同的随机数
-        static std::uniform_real_distribution<> distribution(0.0, 1.0);
-        static std::mt19937 generator(rd());
-        return distribution(generator);
-    }
-
-    //生成一个[min, max)之间的浮点随机数
-    inline double randomDouble(const double min, const double max) {
-        return min + (max - min) * randomDouble();
+    //将64位整数的所有位充分混合（SplitMix64的最终混合步骤），用于从像素下标等计数器派生随机数种子
+    inline Uint64 mixBits(Uint64 value) {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
     }
 
-    //生成一个[min, max]之间的整数随机数
-    inline int randomInt(const int min, const int max) {
-        //直接使用 randomDouble() 来生成整数，以共享同一个静态生成器
-        return static_cast<int>(randomDouble(min, max + 1));
-    }
+    /*
+     * 随机数生成器（PCG32）
+     * 状态只有两个64位整数，没有全局共享状态，可以按值拷贝并上传到GPU
+     * 渲染时每个像素使用由全局种子和像素下标决定的独立序列，渲染结果与线程数和执行顺序无关，相同种子的结果逐位一致
+     */
+    class RandomGenerator {
+    private:
+        Uint64 state;
+        Uint64 increment; //序列选择器，必须为奇数
+
+    public:
+        explicit RandomGenerator(Uint64 seed = 0x853c49e6748fea9bULL, Uint64 sequence = 0xda3e39cb94b95bdbULL) :
+                state(0), increment(0) {
+            setSequence(seed, sequence);
+        }
+
+        //重置生成器，不同的sequence对应互不相关的随机数序列
+        void setSequence(Uint64 seed, Uint64 sequence) {
+            state = 0;
+            increment = (sequence << 1u) | 1u;
+            nextUint32();
+            state += seed;
+            nextUint32();
+        }
+
+        //生成一个32位无符号随机整数
+        Uint32 nextUint32() {
+            const Uint64 oldState = state;
+            state = oldState * 6364136223846793005ULL + increment;
+            const auto xorShifted = static_cast<Uint32>(((oldState >> 18u) ^ oldState) >> 27u);
+            const auto rotate = static_cast<Uint32>(oldState >> 59u);
+            return (xorShifted >> rotate) | (xorShifted << ((~rotate + 1u) & 31u));
+        }
+
+        //生成一个[0, 1)之间的浮点随机数
+        double nextDouble() {
+            return nextUint32() * (1.0 / 4294967296.0);
+        }
+
+        //生成一个[min, max)之间的浮点随机数
+        double nextDouble(double min, double max) {
+            return min + (max - min) * nextDouble();
+        }
+
+        //生成一个[min, max]之间的整数随机数
+        int nextInt(int min, int max) {
+            return min + static_cast<int>(nextUint32() % static_cast<Uint32>(max - min + 1));
+        }
+    };
 
     //判断浮点数是否接近于0
     inline bool floatValueNearZero(const double val) {
@@ -12,9 +12,32 @@
 #include <material/Dielectric.hpp>
 #include <box/BVHTree.hpp>
 #include <pdf/MixturePDF.hpp>
+#include <pdf/LightSampler.hpp>
+#include <util/ThreadPool.hpp>
+#include <util/Viewer.hpp>
 
 namespace renderer {
-    Uint32 render(Camera & cam, SDL_Window * window, SDL_Surface * surface,
+    /*
+     * 一次渲染的性能统计，由渲染函数在结束时写入，用于基准测试
+     * 时间单位为毫秒，采样时间不包括降噪时间
+     */
+    struct RenderStatistics {
+        Uint32 bvhBuildTime = 0;
+        Uint32 sampleTime = 0;
+        Uint32 denoiseTime = 0;
+        Uint32 passCount = 0;
+        Uint64 primaryRayCount = 0;   //相机光线数，即总采样数
+        Uint64 secondaryRayCount = 0; //反射光线和阴影光线数
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+        TraversalCounters traversal {}; //全局遍历统计
+#endif
+    };
+
+    /*
+     * 渲染场景，返回渲染时间（毫秒，包括降噪）
+     * statistics不为nullptr时写入本次渲染的性能统计
+     */
+    Uint32 render(Camera & cam, FrameBuffer & frameBuffer, Viewer * viewer,
                   const Rough * roughMaterials, const Metal * metalMaterials,
                   const DiffuseLight * lightMaterials, const Dielectric * dielectricMaterials,
                   const Sphere * spheres, Uint32 sphereCount,
@@ -22,8 +45,10 @@ namespace renderer {
                   const Parallelogram * parallelograms, Uint32 parallelogramCount,
                   const Transform * transforms, Uint32 transformCount,
                   const Box * boxes, Uint32 boxCount,
+                  const TriangleMesh * meshes, Uint32 meshCount,
                   const Sphere * hittablePDFSphere, size_t hittablePDFSphereCount,
-                  const Parallelogram * hittablePDFParallelogram, size_t hittablePDFParallelogramCount);
+                  const Parallelogram * hittablePDFParallelogram, size_t hittablePDFParallelogramCount,
+                  RenderStatistics * statistics = nullptr);
 }
 
 #endif //RENDERERBUILD_RENDER_HPP
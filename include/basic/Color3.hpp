@@ -2,6 +2,7 @@
 #define COLOR3_HPP
 
 #include <util/Range.hpp>
+#include <basic/VectorRegister.hpp>
 
 namespace renderer {
     /*
@@ -9,17 +10,25 @@ namespace renderer {
      */
     class Color3 {
     private:
-        double elements[3] {}; //C++11 空列表初始化，数组所有元素初始化为类型默认值
+        Real elements[VectorRegister::STORAGE_SIZE] {}; //C++11 空列表初始化，数组所有元素初始化为类型默认值，SIMD构建时第4个分量为填充
+
+        explicit Color3(const VectorRegister & reg) {
+            reg.store(elements);
+        }
+
+        VectorRegister toRegister() const {
+            return VectorRegister::load(elements);
+        }
 
     public:
-        explicit Color3(double r = 0.0, double g = 0.0, double b = 0.0) {
+        explicit Color3(Real r = 0.0, Real g = 0.0, Real b = 0.0) {
             elements[0] = r; elements[1] = g; elements[2] = b;
         }
 
-        double & operator[](size_t index) {
+        Real & operator[](size_t index) {
             return elements[index];
         }
-        double operator[](size_t index) const {
+        Real operator[](size_t index) const {
             return elements[index];
         }
 
@@ -27,86 +36,95 @@ namespace renderer {
 
         //不进行范围校验，只在写入时裁切范围
         Color3 & operator+=(const Color3 & obj) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] += obj.elements[i];
-            }
+            (toRegister() + obj.toRegister()).store(elements);
             return *this;
         }
 
         Color3 operator+(const Color3 & obj) const {
-            Color3 ret(*this); ret += obj; return ret;
+            return Color3(toRegister() + obj.toRegister());
         }
 
         Color3 & operator-=(const Color3 & obj) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] -= obj.elements[i];
-            }
+            (toRegister() - obj.toRegister()).store(elements);
             return *this;
         }
 
         Color3 operator-(const Color3 & obj) const {
-            Color3 ret(*this); ret -= obj; return ret;
+            return Color3(toRegister() - obj.toRegister());
         }
 
-        Color3 & operator*=(double num) {
-            for (double & element : elements) {
-                element *= num;
-            }
+        Color3 & operator*=(Real num) {
+            (toRegister() * VectorRegister::broadcast(num)).store(elements);
             return *this;
         }
 
-        Color3 operator*(double num) const {
-            Color3 ret(*this); ret *= num; return ret;
+        Color3 operator*(Real num) const {
+            return Color3(toRegister() * VectorRegister::broadcast(num));
         }
 
-        Color3 & operator/=(double num) {
-            for (double & element : elements) {
-                element /= num;
-            }
+        Color3 & operator/=(Real num) {
+            (toRegister() / VectorRegister::broadcast(num)).store(elements);
             return *this;
         }
 
-        Color3 operator/(double num) const {
-            Color3 ret(*this); ret /= num; return ret;
+        Color3 operator/(Real num) const {
+            return Color3(toRegister() / VectorRegister::broadcast(num));
         }
 
         Color3 & operator*=(const Color3 & obj) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] *= obj.elements[i];
-            }
+            (toRegister() * obj.toRegister()).store(elements);
             return *this;
         }
 
         Color3 operator*(const Color3 & obj) const {
-            Color3 ret(*this); ret *= obj; return ret;
+            return Color3(toRegister() * obj.toRegister());
         }
 
         Color3 & operator/=(const Color3 & obj) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] /= obj.elements[i];
-            }
+            (toRegister() / obj.toRegister()).store(elements);
             return *this;
         }
 
         Color3 operator/(const Color3 & obj) const {
-            Color3 ret(*this); ret /= obj; return ret;
+            return Color3(toRegister() / obj.toRegister());
         }
 
-        friend Color3 operator*(double num, const Color3 & obj) {
+        friend Color3 operator*(Real num, const Color3 & obj) {
             return obj * num;
         }
 
-        friend Color3 operator/(double num, const Color3 & obj) {
+        friend Color3 operator/(Real num, const Color3 & obj) {
             return obj / num;
         }
 
+        //累加c1 * c2或obj * num，用于将吞吐量与光照的乘积累加到辐射度，乘法和加法在同一组寄存器中完成
+        Color3 & addProduct(const Color3 & c1, const Color3 & c2) {
+            VectorRegister::multiplyAdd(c1.toRegister(), c2.toRegister(), toRegister()).store(elements);
+            return *this;
+        }
+
+        Color3 & addProduct(const Color3 & obj, Real num) {
+            VectorRegister::multiplyAdd(obj.toRegister(), VectorRegister::broadcast(num), toRegister()).store(elements);
+            return *this;
+        }
+
+        //相对亮度（Rec.709系数），用于估计像素采样的方差
+        Real luminance() const {
+            return 0.2126 * elements[0] + 0.7152 * elements[1] + 0.0722 * elements[2];
+        }
+
+        //三个分量中的最大值，用于俄罗斯轮盘赌计算光路的存活概率
+        Real maxComponent() const {
+            return std::max(elements[0], std::max(elements[1], elements[2]));
+        }
+
         //颜色写入函数
-        void writeColor(Uint32 * pixelPointer, const SDL_PixelFormat * format, double gamma = 2.0) const {
+        void writeColor(Uint32 * pixelPointer, const SDL_PixelFormat * format, Real gamma = 2.0) const {
             //进行伽马校正
-            const double power = 1.0 / gamma;
-            const double r = std::pow(elements[0], power);
-            const double g = std::pow(elements[1], power);
-            const double b = std::pow(elements[2], power);
+            const Real power = 1.0 / gamma;
+            const Real r = std::pow(elements[0], power);
+            const Real g = std::pow(elements[1], power);
+            const Real b = std::pow(elements[2], power);
 
             //将[0.0, 1.0]的颜色值映射到[0, 255]并写入
             const Range intensity(0.0, 0.999);
@@ -120,8 +138,11 @@ namespace renderer {
         // ====== 静态操作函数 ======
 
         //生成随机颜色
-        static Color3 randomColor(double min = 0.0, double max = 1.0) {
-            return Color3(randomDouble(min, max), randomDouble(min, max), randomDouble(min, max));
+        static Color3 randomColor(RandomGenerator & rng, Real min = 0.0, Real max = 1.0) {
+            const Real r = rng.nextDouble(min, max);
+            const Real g = rng.nextDouble(min, max);
+            const Real b = rng.nextDouble(min, max);
+            return Color3(r, g, b);
         }
 
         // ====== 类封装函数 ======
@@ -9,79 +9,89 @@ namespace renderer {
      */
     class Point3 {
     private:
-        double elements[3] {};
+        Real elements[VectorRegister::STORAGE_SIZE] {}; //SIMD构建时第4个分量为填充
 
     public:
-        explicit Point3(double x = 0.0, double y = 0.0, double z = 0.0) {
+        explicit Point3(Real x = 0.0, Real y = 0.0, Real z = 0.0) {
             elements[0] = x; elements[1] = y; elements[2] = z;
         }
         explicit Point3(const Vec3 & obj) {
-            for (size_t i = 0; i < 3; i++) { elements[i] = obj[i]; }
+            obj.toRegister().store(elements);
+        }
+        explicit Point3(const VectorRegister & reg) {
+            reg.store(elements);
         }
 
-        double & operator[](size_t index) {
+        Real & operator[](size_t index) {
             return elements[index];
         }
-        double operator[](size_t index) const {
+        Real operator[](size_t index) const {
             return elements[index];
         }
 
+        VectorRegister toRegister() const {
+            return VectorRegister::load(elements);
+        }
+
         // ====== 对象操作函数 ======
 
-        double distanceSquare(const Point3 & anotherPoint) const {
-            double sum = 0.0;
-            for (size_t i = 0; i < 3; i++) {
-                sum += (elements[i] - anotherPoint.elements[i]) * (elements[i] - anotherPoint.elements[i]);
-            }
-            return sum;
+        Real distanceSquare(const Point3 & anotherPoint) const {
+            const VectorRegister difference = toRegister() - anotherPoint.toRegister();
+            return VectorRegister::dot(difference, difference);
         }
 
-        double distance(const Point3 & anotherPoint) const {
+        Real distance(const Point3 & anotherPoint) const {
             return std::sqrt(distanceSquare(anotherPoint));
         }
 
         Point3 & operator+=(const Vec3 & offset) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] += offset[i];
-            }
+            (toRegister() + offset.toRegister()).store(elements);
             return *this;
         }
 
         Point3 operator+(const Vec3 & offset) const {
-            Point3 ret(*this); ret += offset; return ret;
+            return Point3(toRegister() + offset.toRegister());
         }
 
         Point3 & operator-=(const Vec3 & offset) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] -= offset[i];
-            }
+            (toRegister() - offset.toRegister()).store(elements);
             return *this;
         }
 
         Point3 operator-(const Vec3 & offset) const {
-            Point3 ret(*this); ret -= offset; return ret;
+            return Point3(toRegister() - offset.toRegister());
         }
 
         Vec3 toVector() const  {
-            return Vec3(elements[0], elements[1], elements[2]);
+            return Vec3(toRegister());
         }
 
         // ====== 静态操作函数 ======
 
-        static inline double distanceSquare(const Point3 & p1, const Point3 & p2) {
+        static inline Real distanceSquare(const Point3 & p1, const Point3 & p2) {
             return p1.distanceSquare(p2);
         }
 
-        static inline double distance(const Point3 & p1, const Point3 & p2) {
+        static inline Real distance(const Point3 & p1, const Point3 & p2) {
             return std::sqrt(p1.distanceSquare(p2));
         }
 
         static inline Vec3 constructVector(const Point3 & from, const Point3 & to) {
-            Vec3 ret;
-            for (size_t i = 0; i < 3; i++) {
-                ret[i] = to.elements[i] - from.elements[i];
-            }
-            return ret;
+            return Vec3(to.toRegister() - from.toRegister());
+        }
+
+        //从origin沿direction移动num倍后的点：direction * num + origin
+        static inline Point3 multiplyAdd(const Vec3 & direction, Real num, const Point3 & origin) {
+            return Point3(VectorRegister::multiplyAdd(direction.toRegister(), VectorRegister::broadcast(num), origin.toRegister()));
+        }
+
+        //逐分量最小值和最大值，用于计算点集的包围盒
+        static inline Point3 min(const Point3 & p1, const Point3 & p2) {
+            return Point3(VectorRegister::min(p1.toRegister(), p2.toRegister()));
+        }
+
+        static inline Point3 max(const Point3 & p1, const Point3 & p2) {
+            return Point3(VectorRegister::max(p1.toRegister(), p2.toRegister()));
         }
 
         // ====== 类封装函数 ======
@@ -11,17 +11,42 @@ namespace renderer {
      */
     class Ray {
     public:
+        /*
+         * 新光线起点的偏移距离与坐标量级之比，以及坐标量级的下限
+         * 交点坐标的舍入误差与入射光线起点和交点坐标的绝对值成正比，固定的偏移距离或检测下限在远离原点处不足、在原点附近又过大
+         * 比例按Real的机器精度计算，float和double构建的偏移都覆盖各自的舍入误差
+         */
+        static constexpr Real ORIGIN_OFFSET_SCALE = 256 * std::numeric_limits<Real>::epsilon();
+        static constexpr Real ORIGIN_OFFSET_MIN_MAGNITUDE = 1.0 / 32.0;
+
         Point3 origin;
         Vec3 direction;
-        double time;
+        Real time;
 
         explicit Ray(const Point3 & origin = Point3(), const Vec3 & direction = Vec3(1.0, 0.0, 0.0),
-                     double time = 0.0) : origin(origin), direction(direction), time(time) {}
+                     Real time = 0.0) : origin(origin), direction(direction), time(time) {}
 
         // ====== 对象操作函数 ======
 
-        Point3 at(double t) const {
-            return origin + t * direction;
+        Point3 at(Real t) const {
+            return Point3::multiplyAdd(direction, t, origin);
+        }
+
+        // ====== 静态操作函数 ======
+
+        /*
+         * 从入射光线in的碰撞点沿direction发射新光线（散射光线、阴影光线），时间与入射光线相同
+         * 起点沿法向量移动到direction所在的一侧，偏移距离与坐标量级成正比，新光线不会因交点的舍入误差再次击中同一表面（自相交）
+         * 起点已经离开表面，新光线的检测范围从0开始，图元使用Range::surrounds严格检测t
+         */
+        static Ray spawn(const Ray & in, const HitRecord & record, const Vec3 & direction) {
+            Real magnitude = ORIGIN_OFFSET_MIN_MAGNITUDE;
+            for (size_t i = 0; i < 3; i++) {
+                magnitude = std::max(magnitude, std::max(std::abs(record.hitPoint[i]), std::abs(in.origin[i])));
+            }
+            const Real distance = ORIGIN_OFFSET_SCALE * magnitude;
+            const Vec3 offset = record.normalVector * (Vec3::dot(record.normalVector, direction) > 0.0 ? distance : -distance);
+            return Ray(record.hitPoint + offset, direction, in.time);
         }
     };
 }
@@ -6,7 +6,7 @@
 namespace renderer {
     //图元类型枚举
     enum class PrimitiveType {
-        SPHERE, TRIANGLE, PARALLELOGRAM, TRANSFORM, BOX
+        SPHERE, TRIANGLE, PARALLELOGRAM, TRANSFORM, BOX, MESH
     };
 
     //材质类型枚举
@@ -23,7 +23,7 @@ namespace renderer {
     struct HitRecord {
         Point3 hitPoint;
         Vec3 normalVector;
-        double t;
+        Real t;
         bool hitFrontFace;
 
         /*
@@ -33,7 +33,14 @@ namespace renderer {
         MaterialType materialType;
         size_t materialIndex;
 
-        std::pair<double, double> uvPair;
+        /*
+         * 被击中的图元类型和物体下标，用于查找被击中的光源
+         * 只有球体、平行四边形和三角形记录物体下标，其他图元只记录类型，物体下标保持默认值0
+         */
+        PrimitiveType primitiveType;
+        size_t objectID = 0;
+
+        std::pair<Real, Real> uvPair;
     };
 }
 
@@ -0,0 +1,27 @@
+#ifndef RENDERERBUILD_TRAVERSALRAY_HPP
+#define RENDERERBUILD_TRAVERSALRAY_HPP
+
+#include <basic/Ray.hpp>
+
+namespace renderer {
+    /*
+     * 用于包围盒slab测试的光线，在光线基础上缓存方向的倒数和方向的符号
+     * 每条光线在遍历开始时构造一次，之后所有节点的包围盒测试都只需要乘法，不需要除法
+     * 方向分量为0时倒数为IEEE无穷大：光线起点不在slab内时区间为空集，在slab内时为(-inf, inf)，不需要单独判断平行的情况
+     * 起点恰好位于slab边界上时结果为NaN，各slab测试中NaN比较结果为false，不收缩区间
+     */
+    class TraversalRay : public Ray {
+    public:
+        Real invDirection[3];
+        bool isDirectionNegative[3]; //方向为负时近平面为包围盒的最大值一侧
+
+        explicit TraversalRay(const Ray & ray) : Ray(ray) {
+            for (int i = 0; i < 3; i++) {
+                invDirection[i] = 1.0 / direction[i];
+                isDirectionNegative[i] = invDirection[i] < 0.0; //-0.0的倒数为负无穷，与方向符号一致
+            }
+        }
+    };
+}
+
+#endif //RENDERERBUILD_TRAVERSALRAY_HPP
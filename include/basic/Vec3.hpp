@@ -1,7 +1,8 @@
 #ifndef RENDERERTEST_VEC3_HPP
 #define RENDERERTEST_VEC3_HPP
 
-#include <Global.hpp>
+#include <util/Sampler.hpp>
+#include <basic/VectorRegister.hpp>
 
 namespace renderer {
     /*
@@ -16,146 +17,164 @@ namespace renderer {
      */
     class Vec3 {
     private:
-        double elements[3] {};
+        Real elements[VectorRegister::STORAGE_SIZE] {}; //SIMD构建时第4个分量为填充
 
     public:
-        static constexpr double VECTOR_LENGTH_SQUARE_ZERO_EPSILON = FLOAT_VALUE_ZERO_EPSILON * FLOAT_VALUE_ZERO_EPSILON;
+        static constexpr Real VECTOR_LENGTH_SQUARE_ZERO_EPSILON = FLOAT_VALUE_ZERO_EPSILON * FLOAT_VALUE_ZERO_EPSILON;
 
-        explicit Vec3(double x = 0.0, double y = 0.0, double z = 0.0) {
+        explicit Vec3(Real x = 0.0, Real y = 0.0, Real z = 0.0) {
             elements[0] = x; elements[1] = y; elements[2] = z;
         }
+        explicit Vec3(const VectorRegister & reg) {
+            reg.store(elements);
+        }
 
-        double & operator[](size_t index) {
+        Real & operator[](size_t index) {
             return elements[index];
         }
-        double operator[](size_t index) const {
+        Real operator[](size_t index) const {
             return elements[index];
         }
 
+        VectorRegister toRegister() const {
+            return VectorRegister::load(elements);
+        }
+
         // ====== 对象操作函数 ======
 
         Vec3 operator-() const {
-            return Vec3(-elements[0], -elements[1], -elements[2]);
+            return Vec3(-toRegister());
         }
 
         Vec3 & negate() {
-            for (double & element : elements) {
-                element = -element;
-            }
+            (-toRegister()).store(elements);
             return *this;
         }
 
         Vec3 & operator+=(const Vec3 & obj) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] += obj.elements[i];
-            }
+            (toRegister() + obj.toRegister()).store(elements);
             return *this;
         }
 
         Vec3 operator+(const Vec3 & obj) const {
-            Vec3 ret(*this); ret += obj; return ret;
+            return Vec3(toRegister() + obj.toRegister());
         }
 
         Vec3 & operator-=(const Vec3 & obj) {
-            for (size_t i = 0; i < 3; i++) {
-                elements[i] -= obj.elements[i];
-            }
+            (toRegister() - obj.toRegister()).store(elements);
             return *this;
         }
 
         Vec3 operator-(const Vec3 & obj) const {
-            Vec3 ret(*this); ret -= obj; return ret;
+            return Vec3(toRegister() - obj.toRegister());
         }
 
-        Vec3 & operator*=(double num) {
-            for (double & element : elements) {
-                element *= num;
-            }
+        Vec3 & operator*=(Real num) {
+            (toRegister() * VectorRegister::broadcast(num)).store(elements);
             return *this;
         }
 
-        Vec3 operator*(double num) const {
-            Vec3 ret(*this); ret *= num; return ret;
+        Vec3 operator*(Real num) const {
+            return Vec3(toRegister() * VectorRegister::broadcast(num));
         }
 
-        Vec3 & operator/=(double num) {
-            for (double & element : elements) {
-                element /= num;
-            }
+        Vec3 & operator/=(Real num) {
+            (toRegister() / VectorRegister::broadcast(num)).store(elements);
             return *this;
         }
 
-        Vec3 operator/(double num) const {
-            Vec3 ret(*this); ret /= num; return ret;
+        Vec3 operator/(Real num) const {
+            return Vec3(toRegister() / VectorRegister::broadcast(num));
         }
 
         //数乘除操作允许左操作数为实数
 
-        friend Vec3 & operator*=(double num, Vec3 & obj) {
+        friend Vec3 & operator*=(Real num, Vec3 & obj) {
             return obj *= num;
         }
 
-        friend Vec3 & operator/=(double num, Vec3 & obj) {
+        friend Vec3 & operator/=(Real num, Vec3 & obj) {
             return obj /= num;
         }
 
-        friend Vec3 operator*(double num, const Vec3 & obj) {
-            Vec3 ret(obj); ret *= num; return ret;
+        friend Vec3 operator*(Real num, const Vec3 & obj) {
+            return obj * num;
         }
 
-        friend Vec3 operator/(double num, const Vec3 & obj) {
-            Vec3 ret(obj); ret /= num; return ret;
+        friend Vec3 operator/(Real num, const Vec3 & obj) {
+            return obj / num;
         }
 
-        double lengthSquare() const {
-            double sum = 0.0;
-            for (const double & element : elements) {
-                sum += element * element;
-            }
-            return sum;
+        Real lengthSquare() const {
+            const VectorRegister reg = toRegister();
+            return VectorRegister::dot(reg, reg);
         }
 
-        double length() const {
+        Real length() const {
             return std::sqrt(lengthSquare());
         }
 
-        double dot(const Vec3 & obj) const {
-            double sum = 0.0;
-            for (size_t i = 0; i < 3; i++) {
-                sum += elements[i] * obj.elements[i];
-            }
-            return sum;
+        Real dot(const Vec3 & obj) const {
+            return VectorRegister::dot(toRegister(), obj.toRegister());
         }
 
         Vec3 cross(const Vec3 & obj) const {
-            return Vec3(elements[1] * obj.elements[2] - elements[2] * obj.elements[1],
-                        elements[2] * obj.elements[0] - elements[0] * obj.elements[2],
-                        elements[0] * obj.elements[1] - elements[1] * obj.elements[0]);
+            return Vec3(VectorRegister::cross(toRegister(), obj.toRegister()));
         }
 
         Vec3 & unitize() {
-            const double len = length();
-            for (double & element : elements) {
-                element /= len;
-            }
+            const VectorRegister reg = toRegister();
+            (reg / VectorRegister::broadcast(std::sqrt(VectorRegister::dot(reg, reg)))).store(elements);
             return *this;
         }
 
         Vec3 unitVector() const {
-            Vec3 ret(*this); ret.unitize(); return ret;
+            const VectorRegister reg = toRegister();
+            return Vec3(reg / VectorRegister::broadcast(std::sqrt(VectorRegister::dot(reg, reg))));
         }
 
         // ====== 静态操作函数 ======
 
-        //生成遵守按指定轴余弦分布的随机向量，非单位向量
-        static inline Vec3 randomCosineVector(int axis, bool toPositive) {
-            double coord[3];
-            const auto r1 = randomDouble();
-            const auto r2 = randomDouble();
+        // ====== 采样变换函数 ======
+        //将[0, 1)^2上的均匀二维采样值映射为指定分布，不使用拒绝采样，每次调用的计算量固定，可以配合任意采样器使用
+
+        /*
+         * 同心圆盘映射（Shirley-Chiu）：将[0, 1)^2映射为单位圆盘（x，y，0）上的均匀分布
+         * 正方形的同心方环映射为圆盘的同心圆环，保持采样点的分层和相对位置
+         */
+        static inline Vec3 concentricDiskVector(Real u, Real v) {
+            const Real a = 2.0 * u - 1.0;
+            const Real b = 2.0 * v - 1.0;
+            if (a == 0.0 && b == 0.0) {
+                return Vec3();
+            }
+            const bool isHorizontal = std::abs(a) > std::abs(b);
+            const Real radius = isHorizontal ? a : b;
+            const Real phi = isHorizontal ? (PI / 4.0) * (b / a) : (PI / 2.0) - (PI / 4.0) * (a / b);
+            return Vec3(radius * std::cos(phi), radius * std::sin(phi), 0.0);
+        }
+
+        //将[0, 1)^2映射为单位球面上的均匀分布：z在[-1, 1]上均匀分布，方位角在[0, 2π)上均匀分布
+        static inline Vec3 uniformSphereVector(Real u, Real v) {
+            const Real z = 1.0 - 2.0 * u;
+            const Real radius = std::sqrt(std::max(0.0, 1.0 - z * z));
+            const Real phi = 2.0 * PI * v;
+            return Vec3(radius * std::cos(phi), radius * std::sin(phi), z);
+        }
+
+        //将[0, 1)^2映射为以z轴为中心的半球上的余弦分布单位向量（Malley方法：将圆盘上的均匀分布投影到半球）
+        static inline Vec3 cosineHemisphereVector(Real u, Real v) {
+            Vec3 ret = concentricDiskVector(u, v);
+            ret[2] = std::sqrt(std::max(0.0, 1.0 - ret[0] * ret[0] - ret[1] * ret[1]));
+            return ret;
+        }
 
-            coord[0] = cos(2.0 * PI * r1) * 2.0 * sqrt(r2);
-            coord[1] = sin(2.0 * PI * r1) * 2.0 * sqrt(r2);
-            coord[2] = sqrt(1.0 - r2);
+        //生成遵守按指定轴余弦分布的随机单位向量
+        static inline Vec3 randomCosineVector(int axis, bool toPositive, Sampler & sampler) {
+            double u, v;
+            sampler.next2D(u, v);
+            const Vec3 local = cosineHemisphereVector(u, v);
+            Real coord[3] = {local[0], local[1], local[2]};
 
             switch (axis) {
                 case 0:
@@ -176,35 +195,25 @@ namespace renderer {
         }
 
         //生成每个分量都在指定范围内的随机向量
-        static inline Vec3 randomVector(double componentMin, double componentMax) {
-            return Vec3(randomDouble(componentMin, componentMax), randomDouble(componentMin, componentMax), randomDouble(componentMin, componentMax));
+        static inline Vec3 randomVector(Real componentMin, Real componentMax, RandomGenerator & rng) {
+            const Real x = rng.nextDouble(componentMin, componentMax);
+            const Real y = rng.nextDouble(componentMin, componentMax);
+            const Real z = rng.nextDouble(componentMin, componentMax);
+            return Vec3(x, y, z);
         }
 
-        //生成平面（x，y，0）上模长不大于maxLength的向量
-        static inline Vec3 randomPlaneVector(double maxLength) {
-            double x, y;
-            do {
-                x = randomDouble(-1.0, 1.0);
-                y = randomDouble(-1.0, 1.0);
-            } while (x * x + y * y > maxLength * maxLength);
-            return Vec3(x, y, 0.0);
+        //生成平面（x，y，0）上模长不大于maxLength的向量，在半径为maxLength的圆盘上均匀分布
+        static inline Vec3 randomPlaneVector(Real maxLength, Sampler & sampler) {
+            double u, v;
+            sampler.next2D(u, v);
+            return concentricDiskVector(u, v) * maxLength;
         }
 
-        //生成模长为length的空间向量
-        static inline Vec3 randomSpaceVector(double length) {
-            Vec3 ret;
-            double lengthSquare;
-            //先生成单位向量，再缩放到指定模长
-            do {
-                for (size_t i = 0; i < 3; i++) {
-                    ret[i] = randomDouble(-1.0, 1.0);
-                }
-                lengthSquare = ret.lengthSquare();
-            } while (lengthSquare < VECTOR_LENGTH_SQUARE_ZERO_EPSILON);
-
-            //单位化ret，确定模长
-            ret.unitize();
-            return ret * length;
+        //生成模长为length的空间向量，方向在球面上均匀分布
+        static inline Vec3 randomSpaceVector(Real length, Sampler & sampler) {
+            double u, v;
+            sampler.next2D(u, v);
+            return uniformSphereVector(u, v) * length;
         }
 
         static inline Vec3 negativeVector(const Vec3 & obj) {
@@ -219,23 +228,23 @@ namespace renderer {
             return origin - sub;
         }
 
-        static inline Vec3 multiply(const Vec3 & obj, double num) {
+        static inline Vec3 multiply(const Vec3 & obj, Real num) {
             return obj * num;
         }
 
-        static inline Vec3 divide(const Vec3 & origin, double num) {
+        static inline Vec3 divide(const Vec3 & origin, Real num) {
             return origin / num;
         }
 
-        static inline double lengthSquare(const Vec3 & obj) {
+        static inline Real lengthSquare(const Vec3 & obj) {
             return obj.lengthSquare();
         }
 
-        static inline double length(const Vec3 & obj) {
+        static inline Real length(const Vec3 & obj) {
             return obj.length();
         }
 
-        static inline double dot(const Vec3 & v1, const Vec3 & v2) {
+        static inline Real dot(const Vec3 & v1, const Vec3 & v2) {
             return v1.dot(v2);
         }
 
@@ -248,6 +257,20 @@ namespace renderer {
             return obj.unitVector();
         }
 
+        //v1 * num + v2，一次完成缩放和平移
+        static inline Vec3 multiplyAdd(const Vec3 & v1, Real num, const Vec3 & v2) {
+            return Vec3(VectorRegister::multiplyAdd(v1.toRegister(), VectorRegister::broadcast(num), v2.toRegister()));
+        }
+
+        //逐分量最小值和最大值
+        static inline Vec3 min(const Vec3 & v1, const Vec3 & v2) {
+            return Vec3(VectorRegister::min(v1.toRegister(), v2.toRegister()));
+        }
+
+        static inline Vec3 max(const Vec3 & v1, const Vec3 & v2) {
+            return Vec3(VectorRegister::max(v1.toRegister(), v2.toRegister()));
+        }
+
         // ====== 类封装函数 ======
 
         /*
@@ -0,0 +1,268 @@
+#ifndef RENDERERBUILD_VECTORREGISTER_HPP
+#define RENDERERBUILD_VECTORREGISTER_HPP
+
+#include <Global.hpp>
+
+/*
+ * 向量寄存器后端选择，定义RENDERER_SIMD_VECTOR时（CMake选项RENDERER_ENABLE_SIMD_VECTOR）按Real和指令集选择：
+ *     float：一个SSE寄存器
+ *     double：定义__AVX__时为一个256位寄存器，否则为两个SSE2寄存器（xy和z）
+ * 未定义RENDERER_SIMD_VECTOR或目标平台不支持SSE2时使用标量实现
+ */
+#ifdef RENDERER_SIMD_VECTOR
+#if defined(RENDERER_FLOAT_PRECISION) && (defined(__SSE2__) || defined(_M_X64))
+#define RENDERER_VECTOR_REGISTER_SSE_FLOAT
+#elif !defined(RENDERER_FLOAT_PRECISION) && defined(__AVX__)
+#define RENDERER_VECTOR_REGISTER_AVX_DOUBLE
+#elif !defined(RENDERER_FLOAT_PRECISION) && (defined(__SSE2__) || defined(_M_X64))
+#define RENDERER_VECTOR_REGISTER_SSE2_DOUBLE
+#endif
+#endif
+
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT) || defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE) || defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+#include <immintrin.h>
+#endif
+
+namespace renderer {
+    /*
+     * 三维量（Vec3、Point3、Color3）的逐分量运算后端，三个类的运算符都通过此类实现，不直接操作分量数组
+     * SIMD实现中三维量按STORAGE_SIZE = 4个分量存储，第4个分量为填充：构造时为0，逐分量运算不关心其值，点积只累加前3个分量
+     * 加载和存储不要求对齐，C++11的std::vector不保证超过16字节的对齐
+     *
+     * 所有实现的运算顺序相同：乘加先乘后加（不使用FMA指令），点积按(x + y) + z累加，min和max与std::min和std::max的参数顺序一致，
+     * 因此标量和SIMD构建的渲染结果逐位相同，可以直接对比性能
+     */
+    class VectorRegister {
+    public:
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT) || defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE) || defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+        static constexpr size_t STORAGE_SIZE = 4;
+#else
+        static constexpr size_t STORAGE_SIZE = 3;
+#endif
+
+    private:
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+        __m128 value;
+
+        explicit VectorRegister(__m128 value) : value(value) {}
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+        __m256d value;
+
+        explicit VectorRegister(__m256d value) : value(value) {}
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+        __m128d xy;
+        __m128d zw; //低位为z，高位为填充
+
+        VectorRegister(__m128d xy, __m128d zw) : xy(xy), zw(zw) {}
+#else
+        Real value[3];
+
+        VectorRegister() : value() {}
+#endif
+
+    public:
+        // ====== 加载和存储 ======
+
+        //从STORAGE_SIZE个分量的数组加载
+        static VectorRegister load(const Real * elements) {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            return VectorRegister(_mm_loadu_ps(elements));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            return VectorRegister(_mm256_loadu_pd(elements));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            return {_mm_loadu_pd(elements), _mm_loadu_pd(elements + 2)};
+#else
+            VectorRegister ret;
+            for (size_t i = 0; i < 3; i++) {
+                ret.value[i] = elements[i];
+            }
+            return ret;
+#endif
+        }
+
+        //所有分量为num
+        static VectorRegister broadcast(Real num) {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            return VectorRegister(_mm_set1_ps(num));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            return VectorRegister(_mm256_set1_pd(num));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            return {_mm_set1_pd(num), _mm_set1_pd(num)};
+#else
+            VectorRegister ret;
+            for (Real & element : ret.value) {
+                element = num;
+            }
+            return ret;
+#endif
+        }
+
+        //写入STORAGE_SIZE个分量的数组
+        void store(Real * elements) const {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            _mm_storeu_ps(elements, value);
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            _mm256_storeu_pd(elements, value);
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            _mm_storeu_pd(elements, xy);
+            _mm_storeu_pd(elements + 2, zw);
+#else
+            for (size_t i = 0; i < 3; i++) {
+                elements[i] = value[i];
+            }
+#endif
+        }
+
+        // ====== 逐分量运算 ======
+
+        //取反只翻转符号位，与标量的-x相同（0.0取反为-0.0）
+        VectorRegister operator-() const {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            return VectorRegister(_mm_xor_ps(value, _mm_set1_ps(-0.0f)));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            return VectorRegister(_mm256_xor_pd(value, _mm256_set1_pd(-0.0)));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            const __m128d sign = _mm_set1_pd(-0.0);
+            return {_mm_xor_pd(xy, sign), _mm_xor_pd(zw, sign)};
+#else
+            VectorRegister ret;
+            for (size_t i = 0; i < 3; i++) {
+                ret.value[i] = -value[i];
+            }
+            return ret;
+#endif
+        }
+
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+#define vectorRegisterBinaryOperator(op, intrinsicPs, intrinsicPd256, intrinsicPd) \
+        friend VectorRegister operator op(const VectorRegister & a, const VectorRegister & b) { \
+            return VectorRegister(intrinsicPs(a.value, b.value)); \
+        }
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+#define vectorRegisterBinaryOperator(op, intrinsicPs, intrinsicPd256, intrinsicPd) \
+        friend VectorRegister operator op(const VectorRegister & a, const VectorRegister & b) { \
+            return VectorRegister(intrinsicPd256(a.value, b.value)); \
+        }
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+#define vectorRegisterBinaryOperator(op, intrinsicPs, intrinsicPd256, intrinsicPd) \
+        friend VectorRegister operator op(const VectorRegister & a, const VectorRegister & b) { \
+            return {intrinsicPd(a.xy, b.xy), intrinsicPd(a.zw, b.zw)}; \
+        }
+#else
+#define vectorRegisterBinaryOperator(op, intrinsicPs, intrinsicPd256, intrinsicPd) \
+        friend VectorRegister operator op(const VectorRegister & a, const VectorRegister & b) { \
+            VectorRegister ret; \
+            for (size_t i = 0; i < 3; i++) { \
+                ret.value[i] = a.value[i] op b.value[i]; \
+            } \
+            return ret; \
+        }
+#endif
+
+        vectorRegisterBinaryOperator(+, _mm_add_ps, _mm256_add_pd, _mm_add_pd)
+        vectorRegisterBinaryOperator(-, _mm_sub_ps, _mm256_sub_pd, _mm_sub_pd)
+        vectorRegisterBinaryOperator(*, _mm_mul_ps, _mm256_mul_pd, _mm_mul_pd)
+        vectorRegisterBinaryOperator(/, _mm_div_ps, _mm256_div_pd, _mm_div_pd)
+
+#undef vectorRegisterBinaryOperator
+
+        //a * b + c，先乘后加，不使用融合乘加，结果与分开计算相同
+        static VectorRegister multiplyAdd(const VectorRegister & a, const VectorRegister & b, const VectorRegister & c) {
+            return a * b + c;
+        }
+
+        //逐分量std::min(a, b)：b < a时取b，否则取a。SSE的min(x, y)在x < y时取x，否则取y，因此参数顺序交换
+        static VectorRegister min(const VectorRegister & a, const VectorRegister & b) {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            return VectorRegister(_mm_min_ps(b.value, a.value));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            return VectorRegister(_mm256_min_pd(b.value, a.value));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            return {_mm_min_pd(b.xy, a.xy), _mm_min_pd(b.zw, a.zw)};
+#else
+            VectorRegister ret;
+            for (size_t i = 0; i < 3; i++) {
+                ret.value[i] = std::min(a.value[i], b.value[i]);
+            }
+            return ret;
+#endif
+        }
+
+        //逐分量std::max(a, b)：a < b时取b，否则取a
+        static VectorRegister max(const VectorRegister & a, const VectorRegister & b) {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            return VectorRegister(_mm_max_ps(b.value, a.value));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            return VectorRegister(_mm256_max_pd(b.value, a.value));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            return {_mm_max_pd(b.xy, a.xy), _mm_max_pd(b.zw, a.zw)};
+#else
+            VectorRegister ret;
+            for (size_t i = 0; i < 3; i++) {
+                ret.value[i] = std::max(a.value[i], b.value[i]);
+            }
+            return ret;
+#endif
+        }
+
+        // ====== 三维运算 ======
+
+        //前3个分量的点积，按(x + y) + z累加
+        static Real dot(const VectorRegister & a, const VectorRegister & b) {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            const __m128 product = _mm_mul_ps(a.value, b.value);
+            const __m128 sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+            return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehl_ps(product, product)));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            const __m256d product = _mm256_mul_pd(a.value, b.value);
+            const __m128d low = _mm256_castpd256_pd128(product);
+            const __m128d sum = _mm_add_sd(low, _mm_unpackhi_pd(low, low));
+            return _mm_cvtsd_f64(_mm_add_sd(sum, _mm256_extractf128_pd(product, 1)));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            const __m128d productXY = _mm_mul_pd(a.xy, b.xy);
+            const __m128d sum = _mm_add_sd(productXY, _mm_unpackhi_pd(productXY, productXY));
+            return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_mul_sd(a.zw, b.zw)));
+#else
+            return a.value[0] * b.value[0] + a.value[1] * b.value[1] + a.value[2] * b.value[2];
+#endif
+        }
+
+        //a x b = a.yzx * b.zxy - a.zxy * b.yzx
+        static VectorRegister cross(const VectorRegister & a, const VectorRegister & b) {
+#if defined(RENDERER_VECTOR_REGISTER_SSE_FLOAT)
+            const __m128 aYZX = _mm_shuffle_ps(a.value, a.value, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m128 aZXY = _mm_shuffle_ps(a.value, a.value, _MM_SHUFFLE(3, 1, 0, 2));
+            const __m128 bYZX = _mm_shuffle_ps(b.value, b.value, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m128 bZXY = _mm_shuffle_ps(b.value, b.value, _MM_SHUFFLE(3, 1, 0, 2));
+            return VectorRegister(_mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX)));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE) && defined(__AVX2__)
+            const __m256d aYZX = _mm256_permute4x64_pd(a.value, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m256d aZXY = _mm256_permute4x64_pd(a.value, _MM_SHUFFLE(3, 1, 0, 2));
+            const __m256d bYZX = _mm256_permute4x64_pd(b.value, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m256d bZXY = _mm256_permute4x64_pd(b.value, _MM_SHUFFLE(3, 1, 0, 2));
+            return VectorRegister(_mm256_sub_pd(_mm256_mul_pd(aYZX, bZXY), _mm256_mul_pd(aZXY, bYZX)));
+#elif defined(RENDERER_VECTOR_REGISTER_AVX_DOUBLE)
+            //AVX没有跨128位的置换指令，分量重排的代价高于计算本身，按分量计算
+            alignas(32) Real u[4], v[4];
+            _mm256_store_pd(u, a.value);
+            _mm256_store_pd(v, b.value);
+            return VectorRegister(_mm256_setr_pd(u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0], 0.0));
+#elif defined(RENDERER_VECTOR_REGISTER_SSE2_DOUBLE)
+            //xy分量：a.yz * b.zx - a.zx * b.yz；z分量：a.x * b.y - a.y * b.x
+            const __m128d aYZ = _mm_shuffle_pd(a.xy, a.zw, 1), aZX = _mm_shuffle_pd(a.zw, a.xy, 0);
+            const __m128d bYZ = _mm_shuffle_pd(b.xy, b.zw, 1), bZX = _mm_shuffle_pd(b.zw, b.xy, 0);
+            const __m128d aYY = _mm_unpackhi_pd(a.xy, a.xy), bYY = _mm_unpackhi_pd(b.xy, b.xy);
+            return {_mm_sub_pd(_mm_mul_pd(aYZ, bZX), _mm_mul_pd(aZX, bYZ)),
+                    _mm_sub_sd(_mm_mul_sd(a.xy, bYY), _mm_mul_sd(aYY, b.xy))};
+#else
+            VectorRegister ret;
+            ret.value[0] = a.value[1] * b.value[2] - a.value[2] * b.value[1];
+            ret.value[1] = a.value[2] * b.value[0] - a.value[0] * b.value[2];
+            ret.value[2] = a.value[0] * b.value[1] - a.value[1] * b.value[0];
+            return ret;
+#endif
+        }
+    };
+}
+
+#endif //RENDERERBUILD_VECTORREGISTER_HPP
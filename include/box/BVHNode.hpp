@@ -0,0 +1,200 @@
+#ifndef RENDERERBUILD_BVHNODE_HPP
+#define RENDERERBUILD_BVHNODE_HPP
+
+#include <box/BoundingBox.hpp>
+#include <util/TraversalStatistics.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace renderer {
+    /*
+     * slab测试中远平面参数的放大系数
+     * 单精度构建以float计算时，减法和乘法的舍入误差可能使擦过包围盒边缘的光线测试失败，远平面参数乘以1 + 2 * gamma(3)（PBRT）保证结果保守
+     * 双精度构建将float包围盒转换为double计算，舍入误差远小于包围盒向外取整的距离，系数为1
+     */
+#ifdef RENDERER_FLOAT_PRECISION
+    constexpr Real BOX_FAR_SCALE = 1.0f + 3.0f * std::numeric_limits<float>::epsilon();
+#else
+    constexpr Real BOX_FAR_SCALE = 1.0;
+#endif
+
+    /*
+     * 四叉宽BVH节点，由二叉树折叠得到，用于遍历
+     * 一个节点直接存储最多4个子节点的包围盒，一次相交测试同时检查所有子节点
+     * 包围盒按SoA布局存储：bounds[axis]为4个子节点在该轴上的最小值，bounds[axis + 3]为最大值，可以直接载入SIMD寄存器
+     * 二叉树的叶子节点不再单独成为节点，其图元区间直接存储在父节点的对应位置
+     * 包围盒使用float存储，转换时最小值向下取整、最大值向上取整，包围盒只会变大，不会丢失任何交点
+     * 每个节点128字节；SSE载入要求16字节对齐，operator new的分配结果满足此要求
+     * 此布局取代了原先的32字节二叉紧凑节点：每个子节点同样占32字节（float包围盒、32位索引和数量），但4个子节点一次测试完成，且叶子不再占用节点
+     */
+    struct alignas(16) BVHWideNode {
+        static constexpr Uint32 WIDTH = 4;
+
+        //树的最大深度，构建时保证二叉树的叶子深度不超过此值，折叠后的宽树深度不会超过二叉树
+        static constexpr Uint32 MAX_TREE_DEPTH = 40;
+
+        //遍历栈的容量：初始压入根节点，每访问一层最多净增WIDTH - 1个元素
+        static constexpr Uint32 TRAVERSAL_STACK_SIZE = (WIDTH - 1) * MAX_TREE_DEPTH + 1;
+
+        float bounds[6][WIDTH];
+
+        //子节点为叶子时为图元索引数组的起始下标，为中间节点时为子节点的下标
+        Uint32 index[WIDTH];
+
+        //子节点的图元数量，为0时为中间节点
+        Uint32 primitiveCount[WIDTH];
+
+        //将所有子节点置为空：空包围盒的最小值为正无穷、最大值为负无穷，与任何光线都不相交，遍历时不需要判断子节点数量
+        void clear() {
+            for (Uint32 i = 0; i < WIDTH; i++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    bounds[axis][i] = std::numeric_limits<float>::infinity();
+                    bounds[axis + 3][i] = -std::numeric_limits<float>::infinity();
+                }
+                index[i] = 0;
+                primitiveCount[i] = 0;
+            }
+        }
+
+        /*
+         * 同时对所有子节点进行包围盒相交测试，返回相交子节点的位掩码，tNear返回光线进入各子节点包围盒的参数
+         * 近平面由光线方向的符号决定：方向为正时为最小值bounds[axis]，为负时为最大值bounds[axis + 3]
+         * 包围盒按float存储，双精度构建转换为double计算，单精度构建直接以float计算，4个子节点恰好占满一个SSE寄存器
+         * 光线起点位于平面上且与其平行时结果为NaN，max/min指令在任一操作数为NaN时返回第二个操作数，因此将累积的区间放在第二个操作数，NaN不收缩区间
+         */
+        int hit(const TraversalRay & ray, const Range & checkRange, Real tNear[WIDTH]) const {
+            const int nearOffset[3] = {
+                    ray.isDirectionNegative[0] ? 3 : 0, ray.isDirectionNegative[1] ? 3 : 0, ray.isDirectionNegative[2] ? 3 : 0
+            };
+#if defined(RENDERER_FLOAT_PRECISION) && (defined(__SSE2__) || defined(_M_X64))
+            __m128 tMin = _mm_set1_ps(checkRange.min);
+            __m128 tMax = _mm_set1_ps(checkRange.max);
+            const __m128 farScale = _mm_set1_ps(BOX_FAR_SCALE);
+            for (int axis = 0; axis < 3; axis++) {
+                const __m128 o = _mm_set1_ps(ray.origin[axis]);
+                const __m128 inv = _mm_set1_ps(ray.invDirection[axis]);
+                const __m128 nearPlane = _mm_load_ps(bounds[axis + nearOffset[axis]]);
+                const __m128 farPlane = _mm_load_ps(bounds[axis + 3 - nearOffset[axis]]);
+                tMin = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(nearPlane, o), inv), tMin);
+                tMax = _mm_min_ps(_mm_mul_ps(_mm_mul_ps(_mm_sub_ps(farPlane, o), inv), farScale), tMax);
+            }
+            _mm_storeu_ps(tNear, tMin);
+            return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+#elif defined(__AVX__)
+            __m256d tMin = _mm256_set1_pd(checkRange.min);
+            __m256d tMax = _mm256_set1_pd(checkRange.max);
+            for (int axis = 0; axis < 3; axis++) {
+                const __m256d o = _mm256_set1_pd(ray.origin[axis]);
+                const __m256d inv = _mm256_set1_pd(ray.invDirection[axis]);
+                const __m256d nearPlane = _mm256_cvtps_pd(_mm_load_ps(bounds[axis + nearOffset[axis]]));
+                const __m256d farPlane = _mm256_cvtps_pd(_mm_load_ps(bounds[axis + 3 - nearOffset[axis]]));
+                tMin = _mm256_max_pd(_mm256_mul_pd(_mm256_sub_pd(nearPlane, o), inv), tMin);
+                tMax = _mm256_min_pd(_mm256_mul_pd(_mm256_sub_pd(farPlane, o), inv), tMax);
+            }
+            _mm256_storeu_pd(tNear, tMin);
+            return _mm256_movemask_pd(_mm256_cmp_pd(tMin, tMax, _CMP_LE_OQ));
+#elif defined(__SSE2__) || defined(_M_X64)
+            //SSE2每个寄存器只能容纳2个double，4个子节点分为低、高两半计算
+            __m128d tMinLow = _mm_set1_pd(checkRange.min), tMinHigh = tMinLow;
+            __m128d tMaxLow = _mm_set1_pd(checkRange.max), tMaxHigh = tMaxLow;
+            for (int axis = 0; axis < 3; axis++) {
+                const __m128d o = _mm_set1_pd(ray.origin[axis]);
+                const __m128d inv = _mm_set1_pd(ray.invDirection[axis]);
+                const __m128 nearPlane = _mm_load_ps(bounds[axis + nearOffset[axis]]);
+                const __m128 farPlane = _mm_load_ps(bounds[axis + 3 - nearOffset[axis]]);
+                tMinLow = _mm_max_pd(_mm_mul_pd(_mm_sub_pd(_mm_cvtps_pd(nearPlane), o), inv), tMinLow);
+                tMinHigh = _mm_max_pd(_mm_mul_pd(_mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(nearPlane, nearPlane)), o), inv), tMinHigh);
+                tMaxLow = _mm_min_pd(_mm_mul_pd(_mm_sub_pd(_mm_cvtps_pd(farPlane), o), inv), tMaxLow);
+                tMaxHigh = _mm_min_pd(_mm_mul_pd(_mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(farPlane, farPlane)), o), inv), tMaxHigh);
+            }
+            _mm_storeu_pd(tNear, tMinLow);
+            _mm_storeu_pd(tNear + 2, tMinHigh);
+            return _mm_movemask_pd(_mm_cmple_pd(tMinLow, tMaxLow)) | (_mm_movemask_pd(_mm_cmple_pd(tMinHigh, tMaxHigh)) << 2);
+#else
+            int mask = 0;
+            for (Uint32 i = 0; i < WIDTH; i++) {
+                Real tMin = checkRange.min;
+                Real tMax = checkRange.max;
+                for (int axis = 0; axis < 3; axis++) {
+                    const Real t1 = (bounds[axis + nearOffset[axis]][i] - ray.origin[axis]) * ray.invDirection[axis];
+                    const Real t2 = (bounds[axis + 3 - nearOffset[axis]][i] - ray.origin[axis]) * ray.invDirection[axis] * BOX_FAR_SCALE;
+                    if (t1 > tMin) tMin = t1;
+                    if (t2 < tMax) tMax = t2;
+                }
+                tNear[i] = tMin;
+                if (tMin <= tMax) mask |= 1 << i;
+            }
+            return mask;
+#endif
+        }
+
+        /*
+         * 遍历宽BVH（栈迭代式），由GPU线程执行
+         * 出栈一个中间节点时同时测试其所有子节点的包围盒，将相交的子节点按进入距离从远到近入栈，最近的子节点最先访问
+         * 栈中同时记录子节点的进入距离，找到更近的交点后，出栈的子节点如果位于交点之后则直接跳过，不需要重新测试包围盒
+         * 到达叶子时调用leafFunction(起始下标, 图元数量)，由其测试图元并在命中时缩小currentRange，返回是否命中
+         * 场景BVH和网格图元的内部BVH共用此函数，只有叶子的解释不同
+         */
+        template<typename LeafFunction>
+        static bool traverse(const BVHWideNode * tree, const TraversalRay & ray, Range & currentRange, LeafFunction & leafFunction) {
+            //待访问节点：primitiveCount大于0时为叶子的图元区间，否则index为宽节点下标
+            struct StackEntry {
+                Uint32 index;
+                Uint32 primitiveCount;
+                Real t;
+            };
+            StackEntry stack[TRAVERSAL_STACK_SIZE];
+            size_t topIndex = 0;
+            stack[topIndex++] = {0, 0, currentRange.min};
+
+            bool isHit = false;
+            while (topIndex > 0) {
+                const StackEntry entry = stack[--topIndex];
+                if (entry.t > currentRange.max) {
+                    continue;
+                }
+
+                if (entry.primitiveCount > 0) {
+                    //叶子节点
+                    if (leafFunction(entry.index, entry.primitiveCount)) {
+                        isHit = true;
+                    }
+                    continue;
+                }
+
+                //中间节点，同时测试所有子节点
+                const BVHWideNode & node = tree[entry.index];
+                traversalStatisticsAdd(nodeCount, 1);
+                Real tNear[WIDTH];
+                const int mask = node.hit(ray, currentRange, tNear);
+                if (mask == 0) {
+                    continue;
+                }
+
+                //按进入距离从小到大对相交的子节点排序（插入排序，最多4个元素）
+                Uint32 order[WIDTH];
+                Uint32 hitCount = 0;
+                for (Uint32 i = 0; i < WIDTH; i++) {
+                    if ((mask & (1 << i)) == 0) continue;
+                    Uint32 j = hitCount++;
+                    while (j > 0 && tNear[order[j - 1]] > tNear[i]) {
+                        order[j] = order[j - 1];
+                        j--;
+                    }
+                    order[j] = i;
+                }
+
+                //先入栈远的子节点，后入栈近的子节点
+                while (hitCount > 0) {
+                    const Uint32 child = order[--hitCount];
+                    stack[topIndex++] = {node.index[child], node.primitiveCount[child], tNear[child]};
+                }
+            }
+            return isHit;
+        }
+    };
+}
+
+#endif //RENDERERBUILD_BVHNODE_HPP
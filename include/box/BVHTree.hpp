@@ -2,11 +2,42 @@
 #define RENDERERBUILD_BVHTREE_HPP
 
 #include <hittable/Transform.hpp>
+#include <box/BVHNode.hpp>
+#include <util/ThreadPool.hpp>
 
 namespace renderer {
+    //BVH节点分割方式
+    enum class BVHSplitMethod {
+        MEDIAN, //沿随机轴从中间分割，每个叶子节点固定包含不超过PRIMITIVE_COUNT_PER_LEAF_NODE个图元
+        SAH     //分箱表面积启发式（Surface Area Heuristic），由代价决定分割位置和叶子节点大小
+    };
+
+    //BVH构建参数
+    struct BVHBuildOptions {
+        BVHSplitMethod splitMethod;
+        Uint32 binCount;              //SAH：每个轴上的分箱数量
+        double traversalCost;         //SAH：访问一个中间节点（两次包围盒测试）的相对代价
+        double intersectionCost;      //SAH：一次图元相交测试的相对代价，决定叶子节点的代价
+        Uint32 maxPrimitiveCountPerLeaf; //SAH：叶子节点的图元数量上限，超过时即使叶子代价更低也继续分割
+        Uint32 threadCount;           //构建线程数，为0时使用硬件线程数
+
+        explicit BVHBuildOptions(BVHSplitMethod splitMethod = BVHSplitMethod::SAH, Uint32 binCount = 16,
+                                 double traversalCost = 1.0, double intersectionCost = 1.0, Uint32 maxPrimitiveCountPerLeaf = 16,
+                                 Uint32 threadCount = 0) :
+                splitMethod(splitMethod), binCount(binCount), traversalCost(traversalCost),
+                intersectionCost(intersectionCost), maxPrimitiveCountPerLeaf(maxPrimitiveCountPerLeaf), threadCount(threadCount) {}
+    };
+
     class BVHTree {
     public:
         static constexpr Uint32 PRIMITIVE_COUNT_PER_LEAF_NODE = 4;
+        static constexpr Uint32 MAX_SAH_BIN_COUNT = 32;
+
+        //并行构建参数：图元数不少于PARALLEL_NODE_THRESHOLD的节点由构建线程使用并行循环处理，
+        //更小的节点作为子树任务提交到线程池；子树任务中图元数不少于SUBTREE_SPLIT_THRESHOLD的子节点继续拆分为新任务，供空闲线程窃取
+        static constexpr size_t PARALLEL_NODE_THRESHOLD = 1 << 16;
+        static constexpr size_t SUBTREE_SPLIT_THRESHOLD = 1 << 10;
+        static constexpr size_t PARALLEL_GRAIN_SIZE = 1 << 14;
 
         struct BVHTreeNode {
             //当前节点的包围盒
@@ -22,6 +53,9 @@ namespace renderer {
             size_t index {};
         };
 
+        //遍历使用的节点布局，定义在box/BVHNode.hpp中，网格图元的内部BVH也使用相同的布局
+        typedef BVHWideNode WideNode;
+
     private:
         //构建过程的任务结构体
         struct BuildingTask {
@@ -32,6 +66,9 @@ namespace renderer {
 
             //该任务对应的节点在线性数组中的位置
             size_t nodeIndex;
+
+            //该任务对应的节点在树中的深度，根节点为0
+            size_t depth;
         };
 
         //构造BVH树的过程中统一数据表示形式
@@ -45,137 +82,619 @@ namespace renderer {
             size_t index {}; //在原始数组中的引用
         };
 
-        //为图元列表构造包围盒
-        static BoundingBox constructListBoundingBox(const std::vector<PrimitiveInfo> & primitives, size_t startIndex, size_t endIndex) {
-            BoundingBox ret = primitives[startIndex].boundingBox;
-            for (size_t i = startIndex + 1; i < (endIndex > primitives.size() ? primitives.size() : endIndex); i++) {
-                ret = BoundingBox(ret, primitives[i].boundingBox);
+        //SAH分箱：落入同一个分箱的图元的包围盒和数量
+        struct SAHBin {
+            BoundingBox boundingBox;
+            size_t primitiveCount {};
+
+            void add(const BoundingBox & box, size_t count) {
+                if (count == 0) return;
+                boundingBox = primitiveCount == 0 ? box : BoundingBox(boundingBox, box);
+                primitiveCount += count;
+            }
+        };
+
+        //图元列表的包围盒和重心包围盒
+        struct ListBounds {
+            BoundingBox boundingBox;
+            Point3 centroidMin;
+            Point3 centroidMax;
+            bool isEmpty;
+
+            ListBounds() : centroidMin(INFINITY, INFINITY, INFINITY), centroidMax(-INFINITY, -INFINITY, -INFINITY), isEmpty(true) {}
+
+            void add(const BoundingBox & box, const Point3 & centroid) {
+                boundingBox = isEmpty ? box : BoundingBox(boundingBox, box);
+                isEmpty = false;
+                centroidMin = Point3::min(centroidMin, centroid);
+                centroidMax = Point3::max(centroidMax, centroid);
             }
+
+            void merge(const ListBounds & obj) {
+                if (obj.isEmpty) return;
+                boundingBox = isEmpty ? obj.boundingBox : BoundingBox(boundingBox, obj.boundingBox);
+                isEmpty = false;
+                centroidMin = Point3::min(centroidMin, obj.centroidMin);
+                centroidMax = Point3::max(centroidMax, obj.centroidMax);
+            }
+        };
+
+        //构建过程的共享数据：图元列表、划分缓冲区、节点数组和已分配的节点数量
+        struct BuildingContext {
+            std::vector<PrimitiveInfo> & primitives;
+            std::vector<PrimitiveInfo> & partitionBuffer;
+            std::vector<BVHTreeNode> & nodes;
+            std::atomic<size_t> & nodeCount;
+            const BVHBuildOptions & options;
+        };
+
+        //计算图元列表[startIndex, endIndex)的包围盒和重心包围盒，pool不为空时并行计算
+        static ListBounds computeListBounds(const std::vector<PrimitiveInfo> & primitives, size_t startIndex, size_t endIndex, ThreadPool * pool) {
+            ListBounds ret;
+            if (pool == nullptr) {
+                for (size_t i = startIndex; i < endIndex; i++) {
+                    ret.add(primitives[i].boundingBox, primitives[i].centroid);
+                }
+                return ret;
+            }
+
+            std::mutex mutex;
+            pool->parallelFor(endIndex - startIndex, PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                ListBounds local;
+                for (size_t i = startIndex + begin; i < startIndex + end; i++) {
+                    local.add(primitives[i].boundingBox, primitives[i].centroid);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                ret.merge(local);
+            });
+            return ret;
+        }
+
+        //按谓词划分图元列表[startIndex, endIndex)，返回满足谓词的图元个数。pool不为空时使用缓冲区进行并行的稳定划分
+        template<typename Predicate>
+        static size_t partitionPrimitives(BuildingContext & context, size_t startIndex, size_t endIndex, Predicate predicate, ThreadPool * pool) {
+            std::vector<PrimitiveInfo> & primitives = context.primitives;
+            if (pool == nullptr) {
+                const auto middle = std::partition(primitives.begin() + (long)startIndex, primitives.begin() + (long)endIndex, predicate);
+                return static_cast<size_t>(middle - (primitives.begin() + (long)startIndex));
+            }
+
+            //第一遍：统计每个块中满足谓词的图元个数
+            const size_t count = endIndex - startIndex;
+            const size_t chunkCount = ThreadPool::chunkCount(count, PARALLEL_GRAIN_SIZE);
+            std::vector<size_t> leftOffsets(chunkCount), rightOffsets(chunkCount);
+            pool->parallelFor(count, PARALLEL_GRAIN_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+                size_t leftCount = 0;
+                for (size_t i = startIndex + begin; i < startIndex + end; i++) {
+                    if (predicate(primitives[i])) leftCount++;
+                }
+                leftOffsets[chunk] = leftCount;
+                rightOffsets[chunk] = (end - begin) - leftCount;
+            });
+
+            //前缀和：计算每个块的图元在划分结果中的起始位置
+            size_t leftTotal = 0;
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                const size_t leftCount = leftOffsets[chunk];
+                leftOffsets[chunk] = leftTotal;
+                leftTotal += leftCount;
+            }
+            size_t rightTotal = leftTotal;
+            for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+                const size_t rightCount = rightOffsets[chunk];
+                rightOffsets[chunk] = rightTotal;
+                rightTotal += rightCount;
+            }
+
+            //第二遍：将图元分散到缓冲区，第三遍：拷贝回图元列表
+            std::vector<PrimitiveInfo> & buffer = context.partitionBuffer;
+            pool->parallelFor(count, PARALLEL_GRAIN_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+                size_t left = startIndex + leftOffsets[chunk];
+                size_t right = startIndex + rightOffsets[chunk];
+                for (size_t i = startIndex + begin; i < startIndex + end; i++) {
+                    buffer[predicate(primitives[i]) ? left++ : right++] = primitives[i];
+                }
+            });
+            pool->parallelFor(count, PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                std::copy(buffer.begin() + (long)(startIndex + begin), buffer.begin() + (long)(startIndex + end),
+                          primitives.begin() + (long)(startIndex + begin));
+            });
+            return leftTotal;
+        }
+
+        /*
+         * 中位数分割：沿随机轴选出中位数并从中间分割，返回右子树图元在任务中的起始偏移
+         * 分割轴由任务的图元范围决定，与节点的构建顺序无关，相同场景每次构建出相同的树
+         */
+        static size_t splitMedian(BuildingContext & context, const BuildingTask & task, int & axis) {
+            axis = static_cast<int>(mixBits(task.primitiveStartIndex * 0x9e3779b97f4a7c15ULL + task.primitiveCount) % 3);
+            const size_t mid = task.primitiveCount / 2;
+            const auto begin = context.primitives.begin() + (long)task.primitiveStartIndex;
+            std::nth_element(begin, begin + (long)mid, begin + (long)task.primitiveCount,
+                             [axis](const PrimitiveInfo & a, const PrimitiveInfo & b) {
+                                 return a.centroid[axis] < b.centroid[axis];});
+            return mid;
+        }
+
+        //不小于log2(value)的最小整数，即中位数分割将value个图元分到单个图元所需的层数
+        static size_t ceilLog2(size_t value) {
+            size_t ret = 0;
+            while ((static_cast<size_t>(1) << ret) < value) ret++;
+            return ret;
+        }
+
+        //计算图元重心所在的分箱下标
+        static size_t binIndex(double centroid, double minValue, double scale, size_t binCount) {
+            const auto index = static_cast<long>((centroid - minValue) * scale);
+            return std::min(binCount - 1, static_cast<size_t>(std::max(0L, index)));
+        }
+
+        /*
+         * 分箱SAH分割：在每个轴上将图元按重心位置放入若干个分箱，在分箱边界中选择代价最小的分割位置
+         * 代价 = traversalCost + (左包围盒面积 * 左图元数 + 右包围盒面积 * 右图元数) / 节点包围盒面积 * intersectionCost
+         * 如果不分割（作为叶子节点）的代价更低则返回false，否则对图元列表进行划分，返回true并通过mid和axis返回右子树图元的起始偏移和分割轴
+         * pool不为空时并行进行分箱和划分
+         */
+        static bool splitSAH(BuildingContext & context, const BuildingTask & task, const ListBounds & bounds, ThreadPool * pool,
+                             size_t & mid, int & axis) {
+            const BVHBuildOptions & options = context.options;
+            const std::vector<PrimitiveInfo> & primitives = context.primitives;
+            const size_t start = task.primitiveStartIndex;
+            const size_t end = task.primitiveStartIndex + task.primitiveCount;
+            if (task.primitiveCount <= 1) {
+                return false;
+            }
+
+            const size_t binCount = std::max<size_t>(2, std::min<size_t>(options.binCount, static_cast<size_t>(MAX_SAH_BIN_COUNT)));
+            const double nodeArea = bounds.boundingBox.surfaceArea();
+
+            //每个轴上分箱的缩放系数，重心在此轴上重合的轴无法分割，系数为0
+            double scale[3];
+            for (int axis = 0; axis < 3; axis++) {
+                const double extent = bounds.centroidMax[axis] - bounds.centroidMin[axis];
+                scale[axis] = extent < FLOAT_VALUE_ZERO_EPSILON ? 0.0 : static_cast<double>(binCount) / extent;
+            }
+
+            //将图元放入三个轴的分箱
+            SAHBin bins[3][MAX_SAH_BIN_COUNT];
+            const auto fillBins = [&](size_t begin, size_t end, SAHBin (&target)[3][MAX_SAH_BIN_COUNT]) {
+                for (size_t i = begin; i < end; i++) {
+                    for (int axis = 0; axis < 3; axis++) {
+                        if (scale[axis] == 0.0) continue;
+                        target[axis][binIndex(primitives[i].centroid[axis], bounds.centroidMin[axis], scale[axis], binCount)]
+                                .add(primitives[i].boundingBox, 1);
+                    }
+                }
+            };
+            if (pool == nullptr) {
+                fillBins(start, end, bins);
+            } else {
+                std::mutex mutex;
+                pool->parallelFor(task.primitiveCount, PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                    SAHBin local[3][MAX_SAH_BIN_COUNT];
+                    fillBins(start + begin, start + end, local);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (int axis = 0; axis < 3; axis++) {
+                        for (size_t i = 0; i < binCount; i++) {
+                            bins[axis][i].add(local[axis][i].boundingBox, local[axis][i].primitiveCount);
+                        }
+                    }
+                });
+            }
+
+            double bestCost = INFINITY;
+            int bestAxis = -1;
+            size_t bestSplit = 0; //分箱下标小于bestSplit的图元进入左子树
+
+            for (int axis = 0; axis < 3; axis++) {
+                if (scale[axis] == 0.0) {
+                    continue;
+                }
+
+                //从右向左扫描，记录每个分割位置右侧的面积和图元数
+                double rightArea[MAX_SAH_BIN_COUNT];
+                size_t rightCount[MAX_SAH_BIN_COUNT];
+                SAHBin accumulated;
+                for (size_t i = binCount - 1; i > 0; i--) {
+                    accumulated.add(bins[axis][i].boundingBox, bins[axis][i].primitiveCount);
+                    rightArea[i] = accumulated.primitiveCount > 0 ? accumulated.boundingBox.surfaceArea() : 0.0;
+                    rightCount[i] = accumulated.primitiveCount;
+                }
+
+                //从左向右扫描，计算每个分割位置的代价
+                accumulated = SAHBin();
+                for (size_t i = 1; i < binCount; i++) {
+                    accumulated.add(bins[axis][i - 1].boundingBox, bins[axis][i - 1].primitiveCount);
+                    if (accumulated.primitiveCount == 0 || rightCount[i] == 0) {
+                        continue;
+                    }
+                    const double cost = options.traversalCost + options.intersectionCost *
+                            (accumulated.boundingBox.surfaceArea() * accumulated.primitiveCount + rightArea[i] * rightCount[i]) / nodeArea;
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            //不分割的代价为逐个测试所有图元
+            const double leafCost = options.intersectionCost * static_cast<double>(task.primitiveCount);
+            const bool canBeLeaf = task.primitiveCount <= options.maxPrimitiveCountPerLeaf;
+
+            if (bestAxis < 0) {
+                //所有重心重合，SAH无法区分，图元过多时从中间直接分割
+                if (canBeLeaf) {
+                    return false;
+                }
+                mid = task.primitiveCount / 2;
+                axis = 0;
+                return true;
+            }
+            if (canBeLeaf && leafCost <= bestCost) {
+                return false;
+            }
+
+            //按分箱下标划分图元列表
+            const double axisScale = scale[bestAxis];
+            const double minValue = bounds.centroidMin[bestAxis];
+            mid = partitionPrimitives(context, start, end, [=](const PrimitiveInfo & info) {
+                return binIndex(info.centroid[bestAxis], minValue, axisScale, binCount) < bestSplit;
+            }, pool);
+
+            //浮点误差导致划分为空时从中间分割
+            if (mid == 0 || mid == task.primitiveCount) {
+                mid = task.primitiveCount / 2;
+            }
+            axis = bestAxis;
+            return true;
+        }
+
+        /*
+         * 处理一个构建任务：计算节点包围盒，决定是否分割，为中间节点分配左右子节点并返回子任务
+         * 叶子节点的图元在图元列表中连续存放，叶子节点直接引用图元列表中的区间，不需要按构建顺序追加图元索引
+         * 返回true表示当前节点为中间节点
+         */
+        static bool processTask(BuildingContext & context, const BuildingTask & task, ThreadPool * pool,
+                                BuildingTask & leftTask, BuildingTask & rightTask) {
+            const ListBounds bounds = computeListBounds(context.primitives, task.primitiveStartIndex,
+                                                        task.primitiveStartIndex + task.primitiveCount, pool);
+            auto & node = context.nodes[task.nodeIndex];
+            node.boundingBox = bounds.boundingBox;
+
+            //确定是否分割以及分割位置，mid为右子树图元在任务中的起始偏移
+            size_t mid = 0;
+            int axis = 0;
+            bool isLeaf;
+
+            //中位数分割每层将图元数量减半，剩余深度不足以容纳log2(图元数量)层时改用中位数分割，保证叶子深度不超过MAX_TREE_DEPTH
+            //SAH在图元分布极不均匀时（如网格中大量退化或重叠的三角形）每次只能分出少量图元，树深度可能接近图元数量
+            const bool isDepthLimited = task.depth + ceilLog2(task.primitiveCount) >= WideNode::MAX_TREE_DEPTH;
+            if (context.options.splitMethod == BVHSplitMethod::SAH && !isDepthLimited) {
+                isLeaf = !splitSAH(context, task, bounds, pool, mid, axis);
+            } else {
+                isLeaf = task.primitiveCount <= PRIMITIVE_COUNT_PER_LEAF_NODE;
+                if (!isLeaf) {
+                    mid = splitMedian(context, task, axis);
+                }
+            }
+
+            if (isLeaf) {
+                //叶子节点，引用当前task的所有图元
+                node.primitiveCount = task.primitiveCount;
+                node.index = task.primitiveStartIndex;
+                return false;
+            }
+
+            //中间节点，为左右子节点分配空间（分配索引空间），左右子节点相邻
+            const size_t leftChildIndex = context.nodeCount.fetch_add(2);
+            node.primitiveCount = 0;
+            node.index = leftChildIndex;
+
+            //分割图元列表，根据分割结果确定左右子树的所有图元
+            leftTask = {task.primitiveStartIndex, mid, leftChildIndex, task.depth + 1};
+            rightTask = {task.primitiveStartIndex + mid, task.primitiveCount - mid, leftChildIndex + 1, task.depth + 1};
+            return true;
+        }
+
+        //构建一棵子树，由线程池中的工作线程执行。较大的子节点作为新任务提交，供空闲线程窃取
+        static void buildSubtree(BuildingContext & context, ThreadPool & pool, const BuildingTask & rootTask) {
+            std::vector<BuildingTask> stack;
+            stack.push_back(rootTask);
+
+            while (!stack.empty()) {
+                const BuildingTask task = stack.back();
+                stack.pop_back();
+
+                BuildingTask children[2];
+                if (!processTask(context, task, nullptr, children[0], children[1])) {
+                    continue;
+                }
+                for (const auto & child : children) {
+                    if (child.primitiveCount >= SUBTREE_SPLIT_THRESHOLD) {
+                        pool.submit([&context, &pool, child](size_t) { buildSubtree(context, pool, child); });
+                    } else {
+                        stack.push_back(child);
+                    }
+                }
+            }
+        }
+
+        /*
+         * 使用统一数据列表构造BVH节点数组，构建完成后primitiveArray按叶子节点引用的区间重新排列
+         * 场景BVH和网格图元的内部BVH共用此函数
+         */
+        static std::vector<BVHTreeNode> buildNodes(std::vector<PrimitiveInfo> & primitiveArray, const BVHBuildOptions & options, ThreadPool & pool) {
+            //分配存储空间，有N个叶子节点的二叉树共有2N-1个节点
+            std::vector<BVHTreeNode> ret(2 * primitiveArray.size() - 1, BVHTreeNode());
+
+            //并行划分使用的缓冲区，只有顶层的大节点需要
+            std::vector<PrimitiveInfo> partitionBuffer(primitiveArray.size() >= PARALLEL_NODE_THRESHOLD ? primitiveArray.size() : 0);
+
+            //当前分配的节点数量，创建根节点任务，将整个物体数组加入根任务
+            std::atomic<size_t> nodeCount(1);
+            BuildingContext context {primitiveArray, partitionBuffer, ret, nodeCount, options};
+
+            //顶层任务由当前线程处理，节点内部并行；较小的任务提交到线程池构建子树
+            std::vector<BuildingTask> topTasks;
+            topTasks.push_back({0, primitiveArray.size(), 0, 0});
+            while (!topTasks.empty()) {
+                const BuildingTask task = topTasks.back();
+                topTasks.pop_back();
+
+                if (task.primitiveCount < PARALLEL_NODE_THRESHOLD) {
+                    pool.submit([&context, &pool, task](size_t) { buildSubtree(context, pool, task); });
+                    continue;
+                }
+
+                BuildingTask children[2];
+                if (processTask(context, task, &pool, children[0], children[1])) {
+                    topTasks.push_back(children[1]);
+                    topTasks.push_back(children[0]);
+                }
+            }
+            pool.wait();
+            ret.resize(nodeCount);
             return ret;
         }
 
     public:
         /*
-         * 使用物体列表构造BVH节点数组
-         * 构建方式为迭代式构建，广度优先。经典递归式构建为深度优先
-         * 由CPU执行
+         * 使用物体列表构造BVH节点数组，由CPU执行
+         * 分割方式由options决定，默认使用分箱SAH
+         * 构建方式为并行构建：顶层的大节点由当前线程逐个处理，节点内部的包围盒计算、分箱和划分使用并行循环；
+         * 图元较少的节点作为子树任务交给线程池，各线程独立构建子树
          */
         static std::pair<std::vector<BVHTreeNode>, std::vector<std::pair<PrimitiveType, size_t>>> constructBVHTree(
                 const std::vector<Sphere> & spheres,
                 const std::vector<Triangle> & triangles,
                 const std::vector<Parallelogram> & parallelograms,
                 const std::vector<Transform> & transforms,
-                const std::vector<Box> & boxes)
+                const std::vector<Box> & boxes,
+                const std::vector<TriangleMesh> & meshes,
+                const BVHBuildOptions & options = BVHBuildOptions())
         {
-            //构造统一数据列表
-            std::vector<PrimitiveInfo> spherePrimitiveArray(spheres.size(), PrimitiveInfo());
-            for (size_t i = 0; i < spheres.size(); i++) {
-                auto & element = spherePrimitiveArray[i];
-                element.boundingBox = spheres[i].constructBoundingBox(); //预存储包围盒，不用在构造整体包围盒时重复计算图元包围盒
-                element.centroid = spheres[i].center.origin;
-                element.type = PrimitiveType::SPHERE;
-                element.index = i;
+            for (const auto & mesh : meshes) {
+                if (!mesh.hasBVH()) {
+                    throw std::runtime_error("Triangle mesh BVH is not bound!");
+                }
             }
-
-            std::vector<PrimitiveInfo> trianglePrimitiveArray(triangles.size(), PrimitiveInfo());
-            for (size_t i = 0; i < triangles.size(); i++) {
-                auto & element = trianglePrimitiveArray[i];
-                element.boundingBox = triangles[i].constructBoundingBox();
-                element.centroid = triangles[i].centroid();
-                element.type = PrimitiveType::TRIANGLE;
+            ThreadPool pool(options.threadCount);
+
+            //构造统一数据列表，按类型依次排列，并行计算每个图元的包围盒和重心
+            const size_t triangleOffset = spheres.size();
+            const size_t parallelogramOffset = triangleOffset + triangles.size();
+            const size_t transformOffset = parallelogramOffset + parallelograms.size();
+            const size_t boxOffset = transformOffset + transforms.size();
+            const size_t meshOffset = boxOffset + boxes.size();
+            std::vector<PrimitiveInfo> primitiveArray(meshOffset + meshes.size(), PrimitiveInfo());
+
+            pool.parallelFor(spheres.size(), PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    auto & element = primitiveArray[i];
+                    element.boundingBox = spheres[i].constructBoundingBox(); //预存储包围盒，不用在构造整体包围盒时重复计算图元包围盒
+                    element.centroid = spheres[i].center.origin;
+                    element.type = PrimitiveType::SPHERE;
+                    element.index = i;
+                }
+            });
+            pool.parallelFor(triangles.size(), PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    auto & element = primitiveArray[triangleOffset + i];
+                    element.boundingBox = triangles[i].constructBoundingBox();
+                    element.centroid = triangles[i].centroid();
+                    element.type = PrimitiveType::TRIANGLE;
+                    element.index = i;
+                }
+            });
+            pool.parallelFor(parallelograms.size(), PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    auto & element = primitiveArray[parallelogramOffset + i];
+                    element.boundingBox = parallelograms[i].constructBoundingBox();
+                    element.centroid = parallelograms[i].centroid();
+                    element.type = PrimitiveType::PARALLELOGRAM;
+                    element.index = i;
+                }
+            });
+            pool.parallelFor(transforms.size(), PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    auto & element = primitiveArray[transformOffset + i];
+                    element.boundingBox = transforms[i].transformedBoundingBox;
+                    element.centroid = transforms[i].transformedCentroid;
+                    element.type = PrimitiveType::TRANSFORM;
+                    element.index = i;
+                }
+            });
+            pool.parallelFor(boxes.size(), PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    auto & element = primitiveArray[boxOffset + i];
+                    element.boundingBox = boxes[i].constructBoundingBox();
+                    element.centroid = boxes[i].centroid();
+                    element.type = PrimitiveType::BOX;
+                    element.index = i;
+                }
+            });
+            //每个网格作为一个图元，网格内的三角形由网格的内部BVH处理
+            for (size_t i = 0; i < meshes.size(); i++) {
+                auto & element = primitiveArray[meshOffset + i];
+                element.boundingBox = meshes[i].constructBoundingBox();
+                element.centroid = meshes[i].centroid();
+                element.type = PrimitiveType::MESH;
                 element.index = i;
             }
 
-            std::vector<PrimitiveInfo> parallelogramPrimitiveArray(parallelograms.size(), PrimitiveInfo());
-            for (size_t i = 0; i < parallelograms.size(); i++) {
-                auto & element = parallelogramPrimitiveArray[i];
-                element.boundingBox = parallelograms[i].constructBoundingBox();
-                element.centroid = parallelograms[i].centroid();
-                element.type = PrimitiveType::PARALLELOGRAM;
-                element.index = i;
+            std::vector<BVHTreeNode> ret = buildNodes(primitiveArray, options, pool);
+
+            //图元索引数组：叶子节点引用的图元区间与图元列表一一对应
+            std::vector<std::pair<PrimitiveType, size_t>> primitiveIndexArray(primitiveArray.size());
+            pool.parallelFor(primitiveArray.size(), PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    primitiveIndexArray[i] = {primitiveArray[i].type, primitiveArray[i].index};
+                }
+            });
+            return {ret, primitiveIndexArray};
+        }
+
+        //网格图元的内部BVH：宽节点数组和三角形顺序数组，由调用者持有，通过TriangleMesh::bindBVH绑定到网格
+        struct MeshBVH {
+            std::vector<WideNode> nodes;
+            std::vector<Uint32> triangleOrder;
+        };
+
+        /*
+         * 构造网格图元的内部BVH，由CPU执行
+         * 网格中的每个三角形作为一个图元，构建方式与场景BVH相同，构建完成后折叠为宽BVH
+         */
+        static MeshBVH constructMeshBVH(const TriangleMesh & mesh, ThreadPool & pool, const BVHBuildOptions & options) {
+            const Uint32 triangleCount = mesh.getTriangleCount();
+            std::vector<PrimitiveInfo> primitiveArray(triangleCount, PrimitiveInfo());
+            pool.parallelFor(triangleCount, PARALLEL_GRAIN_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    auto & element = primitiveArray[i];
+                    element.boundingBox = mesh.triangleBoundingBox(static_cast<Uint32>(i));
+                    element.centroid = mesh.triangleCentroid(static_cast<Uint32>(i));
+                    element.type = PrimitiveType::TRIANGLE;
+                    element.index = i;
+                }
+            });
+
+            MeshBVH ret;
+            ret.nodes = constructWideTree(buildNodes(primitiveArray, options, pool));
+            ret.triangleOrder.resize(triangleCount);
+            for (size_t i = 0; i < triangleCount; i++) {
+                ret.triangleOrder[i] = static_cast<Uint32>(primitiveArray[i].index);
             }
+            return ret;
+        }
 
-            std::vector<PrimitiveInfo> transformPrimitiveArray(transforms.size(), PrimitiveInfo());
-            for (size_t i = 0; i < transforms.size(); i++) {
-                auto & element = transformPrimitiveArray[i];
-                element.boundingBox = transforms[i].transformedBoundingBox;
-                element.centroid = transforms[i].transformedCentroid;
-                element.type = PrimitiveType::TRANSFORM;
-                element.index = i;
+        //构造所有网格的内部BVH并绑定，返回值需要在网格使用期间保持有效
+        static std::vector<MeshBVH> constructMeshBVH(std::vector<TriangleMesh> & meshes, const BVHBuildOptions & options = BVHBuildOptions()) {
+            ThreadPool pool(options.threadCount);
+            std::vector<MeshBVH> ret;
+            ret.reserve(meshes.size());
+            for (auto & mesh : meshes) {
+                ret.push_back(constructMeshBVH(mesh, pool, options));
+                mesh.bindBVH(ret.back().nodes.data(), ret.back().triangleOrder.data());
             }
+            return ret;
+        }
 
-            std::vector<PrimitiveInfo> boxPrimitiveArray(boxes.size(), PrimitiveInfo());
-            for (size_t i = 0; i < boxes.size(); i++) {
-                auto & element = boxPrimitiveArray[i];
-                element.boundingBox = boxes[i].constructBoundingBox();
-                element.centroid = boxes[i].centroid();
-                element.type = PrimitiveType::BOX;
-                element.index = i;
+        //将float向负无穷方向取整，保证结果不大于value
+        static float roundDown(double value) {
+            auto ret = static_cast<float>(value);
+            if (static_cast<double>(ret) > value) ret = std::nextafter(ret, -std::numeric_limits<float>::infinity());
+            return ret;
+        }
+
+        //将float向正无穷方向取整，保证结果不小于value
+        static float roundUp(double value) {
+            auto ret = static_cast<float>(value);
+            if (static_cast<double>(ret) < value) ret = std::nextafter(ret, std::numeric_limits<float>::infinity());
+            return ret;
+        }
+
+        /*
+         * 将二叉树折叠为四叉宽BVH，图元索引数组保持不变
+         * 每个宽节点对应二叉树的一个中间节点：从其左右子节点开始，不断将表面积最大的中间子节点替换为它的两个子节点，直到有4个子节点或全部为叶子
+         * 表面积越大的节点被光线访问的概率越高，优先展开它可以减少遍历的节点数
+         * 由CPU执行
+         */
+        static std::vector<WideNode> constructWideTree(const std::vector<BVHTreeNode> & nodes) {
+            std::vector<WideNode> ret;
+            if (nodes.empty()) {
+                return ret;
             }
 
-            std::vector<PrimitiveInfo> primitiveArray;
-            primitiveArray.insert(primitiveArray.end(), spherePrimitiveArray.begin(), spherePrimitiveArray.end());
-            primitiveArray.insert(primitiveArray.end(), trianglePrimitiveArray.begin(), trianglePrimitiveArray.end());
-            primitiveArray.insert(primitiveArray.end(), parallelogramPrimitiveArray.begin(), parallelogramPrimitiveArray.end());
-            primitiveArray.insert(primitiveArray.end(), transformPrimitiveArray.begin(), transformPrimitiveArray.end());
-            primitiveArray.insert(primitiveArray.end(), boxPrimitiveArray.begin(), boxPrimitiveArray.end());
+            //待生成的宽节点：(二叉树节点下标, 宽节点下标)，按广度优先顺序生成，pendingDepth为对应宽节点的深度
+            std::vector<std::pair<size_t, size_t>> pending;
+            std::vector<size_t> pendingDepth;
+            ret.emplace_back();
+            pending.emplace_back(0, 0);
+            pendingDepth.push_back(0);
 
-            //分配存储空间，有N个叶子节点的二叉树共有2N-1个节点
-            std::vector<BVHTreeNode> ret(2 * primitiveArray.size() - 1, BVHTreeNode());
+            for (size_t i = 0; i < pending.size(); i++) {
+                const BVHTreeNode & node = nodes[pending[i].first];
+                const size_t wideIndex = pending[i].second;
 
-            //图元索引数组
-            std::vector<std::pair<PrimitiveType, size_t>> primitiveIndexArray(primitiveArray.size());
+                //遍历栈按MAX_TREE_DEPTH分配，构建时已限制二叉树深度，宽树只会更浅
+                if (pendingDepth[i] >= WideNode::MAX_TREE_DEPTH) {
+                    throw std::runtime_error("BVH is too deep for wide node traversal stack!");
+                }
 
-            //当前分配的节点数量
-            size_t nodeCount = 0;
-            //任务队列
-            std::queue<BuildingTask> queue;
-
-            //创建根节点任务，将整个物体数组加入根任务
-            queue.push({0, primitiveArray.size(), 0});
-            nodeCount++;
-
-            while (!queue.empty()) {
-                //弹出一个任务，根据类型选择不同的处理方式
-                auto task = queue.front();
-                queue.pop();
-
-                auto & node = ret[task.nodeIndex];
-                if (task.primitiveCount <= PRIMITIVE_COUNT_PER_LEAF_NODE) {
-                    //叶子节点
-                    //将当前task的所有图元添加到叶子节点中
-                    node.primitiveCount = task.primitiveCount;
-                    node.index = primitiveIndexArray.size();
-                    node.boundingBox = constructListBoundingBox(primitiveArray, task.primitiveStartIndex, task.primitiveStartIndex + task.primitiveCount);
-                    for (size_t i = 0; i < task.primitiveCount; i++) {
-                        primitiveIndexArray.emplace_back(primitiveArray[task.primitiveStartIndex + i].type, primitiveArray[task.primitiveStartIndex + i].index);
-                    }
+                //收集子节点。只有根节点可能是叶子（场景中图元很少时），此时宽节点只有这一个子节点
+                size_t children[WideNode::WIDTH];
+                Uint32 childCount = 0;
+                if (node.primitiveCount > 0) {
+                    children[childCount++] = pending[i].first;
                 } else {
-                    //中间节点，为左右子节点分配空间（分配索引空间）
-                    const size_t leftChildIndex = nodeCount++;
-                    const size_t rightChildIndex = nodeCount++;
-
-                    //随机选择轴排序
-                    const int axis = randomInt(0, 2);
-                    std::sort(primitiveArray.begin() + (int)task.primitiveStartIndex,
-                              primitiveArray.begin() + (int)(task.primitiveStartIndex + task.primitiveCount),
-                              [axis](const PrimitiveInfo & a, const PrimitiveInfo & b) {
-                                  return a.centroid[axis] < b.centroid[axis];});
-
-                    //创建当前节点
-                    node.boundingBox = constructListBoundingBox(primitiveArray, task.primitiveStartIndex, task.primitiveStartIndex + task.primitiveCount);
-                    node.primitiveCount = 0;
-                    node.index = leftChildIndex;
-
-                    //分割图元列表，根据空间排序结果确定左右子树的所有图元
-                    //创建左右节点的子任务并推到队列中，下一次循环先处理左子节点
-                    const size_t mid = task.primitiveCount / 2;
-
-                    queue.push({task.primitiveStartIndex, mid, leftChildIndex});
-                    queue.push({task.primitiveStartIndex + mid, task.primitiveCount - mid, rightChildIndex});
+                    children[childCount++] = node.index;
+                    children[childCount++] = node.index + 1;
+                    while (childCount < WideNode::WIDTH) {
+                        Uint32 expandIndex = WideNode::WIDTH;
+                        double maxArea = -1.0;
+                        for (Uint32 j = 0; j < childCount; j++) {
+                            const BVHTreeNode & child = nodes[children[j]];
+                            if (child.primitiveCount == 0 && child.boundingBox.surfaceArea() > maxArea) {
+                                maxArea = child.boundingBox.surfaceArea();
+                                expandIndex = j;
+                            }
+                        }
+                        if (expandIndex == WideNode::WIDTH) break; //全部为叶子
+
+                        const size_t leftIndex = nodes[children[expandIndex]].index;
+                        children[expandIndex] = leftIndex;
+                        children[childCount++] = leftIndex + 1;
+                    }
                 }
+
+                WideNode wide {};
+                wide.clear();
+                for (Uint32 j = 0; j < childCount; j++) {
+                    const BVHTreeNode & child = nodes[children[j]];
+                    for (size_t axis = 0; axis < 3; axis++) {
+                        wide.bounds[axis][j] = roundDown(child.boundingBox[axis].min);
+                        wide.bounds[axis + 3][j] = roundUp(child.boundingBox[axis].max);
+                    }
+
+                    if (child.primitiveCount > 0) {
+                        if (child.primitiveCount > std::numeric_limits<Uint32>::max() || child.index > std::numeric_limits<Uint32>::max()) {
+                            throw std::runtime_error("BVH leaf out of wide node range!");
+                        }
+                        wide.index[j] = static_cast<Uint32>(child.index);
+                        wide.primitiveCount[j] = static_cast<Uint32>(child.primitiveCount);
+                    } else {
+                        if (ret.size() >= std::numeric_limits<Uint32>::max()) {
+                            throw std::runtime_error("Too many BVH nodes for wide node layout!");
+                        }
+                        wide.index[j] = static_cast<Uint32>(ret.size());
+                        pending.emplace_back(children[j], ret.size());
+                        pendingDepth.push_back(pendingDepth[i] + 1);
+                        ret.emplace_back();
+                    }
+                }
+                ret[wideIndex] = wide;
             }
-            return {ret, primitiveIndexArray};
+            return ret;
         }
 
         //相交测试（递归式）
@@ -221,120 +740,77 @@ namespace renderer {
         }
         */
 
-        //相交测试（栈迭代式），由GPU线程执行
-        static bool hit(const BVHTreeNode * tree, const std::pair<PrimitiveType, size_t> * indexArray,
+        /*
+         * 依次测试叶子节点中的所有图元，由GPU线程执行
+         * 找到交点时更新record并将currentRange.max缩小到交点处
+         */
+        static bool hitLeaf(const std::pair<PrimitiveType, size_t> * leafIndexArray, Uint32 primitiveCount,
+                            const Sphere * spheres,
+                            const Triangle * triangles,
+                            const Parallelogram * parallelograms,
+                            const Transform * transforms,
+                            const Box * boxes,
+                            const TriangleMesh * meshes,
+                            const TraversalRay & ray, Range & currentRange, HitRecord & record)
+        {
+            HitRecord tempRecord;
+            bool isHit = false;
+            for (Uint32 i = 0; i < primitiveCount; i++) {
+                const auto & pair = leafIndexArray[i];
+                bool isPrimitiveHit = false;
+                traversalStatisticsAddPrimitive(pair.first);
+                switch (pair.first) {
+                    case PrimitiveType::SPHERE:
+                        isPrimitiveHit = spheres[pair.second].hit(ray, currentRange, tempRecord);
+                        break;
+                    case PrimitiveType::TRIANGLE:
+                        isPrimitiveHit = triangles[pair.second].hit(ray, currentRange, tempRecord);
+                        break;
+                    case PrimitiveType::PARALLELOGRAM:
+                        isPrimitiveHit = parallelograms[pair.second].hit(ray, currentRange, tempRecord);
+                        break;
+                    case PrimitiveType::TRANSFORM:
+                        isPrimitiveHit = transforms[pair.second].hit(ray, currentRange, tempRecord);
+                        break;
+                    case PrimitiveType::BOX:
+                        isPrimitiveHit = boxes[pair.second].hit(ray, currentRange, tempRecord);
+                        break;
+                    case PrimitiveType::MESH:
+                        isPrimitiveHit = meshes[pair.second].hit(ray, currentRange, tempRecord);
+                        break;
+                    default:;
+                }
+                if (isPrimitiveHit) {
+                    isHit = true;
+                    currentRange.max = tempRecord.t;
+                    record = tempRecord;
+                }
+            }
+            return isHit;
+        }
+
+        /*
+         * 相交测试（栈迭代式），遍历四叉宽BVH，由GPU线程执行
+         * 遍历过程见BVHWideNode::traverse，叶子中的图元依次进行相交测试
+         */
+        static bool hit(const WideNode * tree, const std::pair<PrimitiveType, size_t> * indexArray,
                         const Sphere * spheres,
                         const Triangle * triangles,
                         const Parallelogram * parallelograms,
                         const Transform * transforms,
                         const Box * boxes,
+                        const TriangleMesh * meshes,
                         const Ray & ray, const Range & range, HitRecord & record)
         {
-            //return traverse(nodeArray, primitives, ray, range, record, 0);
-
-            //待访问节点索引
-            size_t stack[64];      //GPU上不能使用std::stack
-            size_t topIndex = 0;   //栈的当前size
-            stack[topIndex++] = 0; //stack.push(0)
-
-            HitRecord tempRecord;
-            bool isHit = false;
+            //每条光线只计算一次方向的倒数和符号
+            const TraversalRay traversalRay(ray);
             Range currentRange(range);
 
-            while (topIndex > 0) {
-                const size_t index = stack[--topIndex]; //弹出栈顶元素。前置--对应后置++
-
-                //检查是否和当前节点的包围盒相交
-                double t;
-                if (!tree[index].boundingBox.hit(ray, currentRange, t)) {
-                    continue;
-                }
-
-                //相交，分为叶子节点和中间节点两种情况
-                const auto & node = tree[index];
-                if (node.primitiveCount > 0) {
-                    //叶子节点
-                    //遍历叶子中的所有图元，依次进行相交测试
-                    for (size_t i = 0; i < node.primitiveCount; i++) {
-                        const auto & pair = indexArray[node.index + i];
-                        switch (pair.first) {
-                            case PrimitiveType::SPHERE:
-                                if (spheres[pair.second].hit(ray, currentRange, tempRecord)) {
-                                    isHit = true;
-                                    currentRange.max = tempRecord.t;
-                                    record = tempRecord;
-                                }
-                                break;
-                            case PrimitiveType::TRIANGLE:
-                                if (triangles[pair.second].hit(ray, currentRange, tempRecord)) {
-                                    isHit = true;
-                                    currentRange.max = tempRecord.t;
-                                    record = tempRecord;
-                                }
-                                break;
-                            case PrimitiveType::PARALLELOGRAM:
-                                if (parallelograms[pair.second].hit(ray, currentRange, tempRecord)) {
-                                    isHit = true;
-                                    currentRange.max = tempRecord.t;
-                                    record = tempRecord;
-                                }
-                                break;
-                            case PrimitiveType::TRANSFORM:
-                                if (transforms[pair.second].hit(ray, currentRange, tempRecord)) {
-                                    isHit = true;
-                                    currentRange.max = tempRecord.t;
-                                    record = tempRecord;
-                                }
-                                break;
-                            case PrimitiveType::BOX:
-                                if (boxes[pair.second].hit(ray, currentRange, tempRecord)) {
-                                    isHit = true;
-                                    currentRange.max = tempRecord.t;
-                                    record = tempRecord;
-                                }
-                                break;
-                            default:;
-                        }
-                    }
-                } else {
-                    //中间节点。将左右子节点的索引入栈
-                    //优先处理更近的节点，将更远的子节点先入栈，后处理
-                    const size_t leftID = node.index;
-                    const size_t rightID = leftID + 1;
-
-                    /*
-                    if (ray.direction[0] < 0) { //如果光线朝x负方向，则x大的节点更近
-                                                //交换左右顺序（这里假设node[left]的x比node[right]小）
-                        std::swap(leftID, rightID);
-                    }
-                     */
-
-                    double tLeft, tRight;
-                    tree[leftID].boundingBox.hit(ray, currentRange, tLeft);
-                    tree[rightID].boundingBox.hit(ray, currentRange, tRight);
-
-                    //先推入t值大的节点下标
-                    //预过滤：只有相交的节点才入栈，避免二次包围盒相交测试
-                    const bool hitLeft = tree[leftID].boundingBox.hit(ray, currentRange, tLeft);
-                    const bool hitRight = tree[rightID].boundingBox.hit(ray, currentRange, tRight);
-
-                    if (hitLeft && hitRight) {
-                        //先推入t值大的（远的）节点，后推入t值小的（近的）节点
-                        if (tLeft > tRight) {
-                            stack[topIndex++] = leftID;
-                            stack[topIndex++] = rightID;
-                        } else {
-                            stack[topIndex++] = rightID;
-                            stack[topIndex++] = leftID; //取消调用swap
-                        }
-                    } else if (hitLeft) {
-                        stack[topIndex++] = leftID;
-                    } else if (hitRight) {
-                        stack[topIndex++] = rightID;
-                    }
-                }
-            }
-            return isHit;
+            auto leafFunction = [&](Uint32 startIndex, Uint32 primitiveCount) {
+                return hitLeaf(indexArray + startIndex, primitiveCount, spheres, triangles, parallelograms, transforms, boxes, meshes,
+                               traversalRay, currentRange, record);
+            };
+            return WideNode::traverse(tree, traversalRay, currentRange, leafFunction);
         }
     };
 }
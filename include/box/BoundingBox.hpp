@@ -1,9 +1,9 @@
 #ifndef RENDERERBUILD_BOUNDINGBOX_HPP
 #define RENDERERBUILD_BOUNDINGBOX_HPP
 
-#include <basic/Ray.hpp>
+#include <basic/TraversalRay.hpp>
 #include <util/Range.hpp>
-#include <util/Matrix.hpp>
+#include <util/AffineMatrix.hpp>
 
 namespace renderer {
     /*
@@ -15,7 +15,7 @@ namespace renderer {
 
         //确保包围盒体积有效
         void ensureVolume() {
-            constexpr double EPSILON = FLOAT_VALUE_ZERO_EPSILON;
+            constexpr Real EPSILON = FLOAT_VALUE_ZERO_EPSILON;
             for (auto & i : range) {
                 if (i.length() < EPSILON) {
                     i.expand(EPSILON);
@@ -40,7 +40,7 @@ namespace renderer {
         }
 
         //使用bounds数组构造包围盒
-        explicit BoundingBox(const double bounds[6]) {
+        explicit BoundingBox(const Real bounds[6]) {
             for (size_t i = 0; i < 6; i += 2) {
                 range[i / 2] = Range(bounds[i], bounds[i + 1]);
             }
@@ -54,66 +54,53 @@ namespace renderer {
             //合并不会减小包围盒的体积
         }
 
-        //使用矩阵变换包围盒
-        BoundingBox transformBoundingBox(const Matrix & matrix) const {
-            //使用矩阵对包围盒的8个顶点进行变换
-            Point3 min(INFINITY, INFINITY, INFINITY);
-            Point3 max(-INFINITY, -INFINITY, -INFINITY);
-
-            for (int i = 0; i < 2; i++) {
-                for (int j = 0; j < 2; j++) {
-                    for (int k = 0; k < 2; k++) {
-                        //取出每个顶点的坐标
-                        const double x = i * range[0].max + (1.0 - i) * range[0].min;
-                        const double y = j * range[1].max + (1.0 - j) * range[1].min;
-                        const double z = k * range[2].max + (1.0 - k) * range[2].min;
-
-                        //计算变换后的坐标
-                        Point3 point(x, y, z);
-                        point = (matrix * Matrix::toMatrix(point.toVector(), 1.0)).toPoint();
-
-                        //计算最值，保证包围盒和坐标轴对齐
-                        for (int l = 0; l < 3; l++) {
-                            min[l] = std::min(min[l], point[l]);
-                            max[l] = std::max(max[l], point[l]);
-                        }
-                    }
+        /*
+         * 使用仿射矩阵变换包围盒
+         * 变换后每个轴的最值等于平移量加上线性部分每一项对原包围盒在对应轴上两个端点取值的最值之和（Arvo方法），不需要逐个变换8个顶点
+         */
+        BoundingBox transformBoundingBox(const AffineMatrix & matrix) const {
+            Point3 min, max;
+            for (int i = 0; i < 3; i++) {
+                min[i] = max[i] = matrix.data[i][3];
+                for (int j = 0; j < 3; j++) {
+                    const Real a = matrix.data[i][j] * range[j].min;
+                    const Real b = matrix.data[i][j] * range[j].max;
+                    min[i] += std::min(a, b);
+                    max[i] += std::max(a, b);
                 }
             }
             //使用min和max重构包围盒
             return {min, max};
         }
 
-        bool hit(const Ray & ray, const Range & checkRange, double & t) const {
-            const Point3 & rayOrigin = ray.origin;
-            const Vec3 & rayDirection = ray.direction;
+        //获取包围盒在指定轴上的范围
+        const Range & operator[](size_t axis) const {
+            return range[axis];
+        }
+
+        //包围盒的表面积，用于SAH代价估计
+        Real surfaceArea() const {
+            const Real dx = range[0].length();
+            const Real dy = range[1].length();
+            const Real dz = range[2].length();
+            return 2.0 * (dx * dy + dy * dz + dz * dx);
+        }
 
+        //slab测试，使用光线缓存的方向倒数和符号，直接取近平面和远平面，不需要除法和交换
+        bool hit(const TraversalRay & ray, const Range & checkRange, Real & t) const {
             Range currentRange(checkRange);
             for (Uint32 axis = 0; axis < 3; axis++) {
                 const Range & axisRange = range[axis];
-                const double q = rayOrigin[axis];
-                const double d = rayDirection[axis];
-
-                //光线和包围盒平行
-                if (std::abs(d) < FLOAT_VALUE_ZERO_EPSILON) {
-                    //光线起点不在包围盒内，没有交点
-                    if (q < axisRange.min || q > axisRange.max) return false;
-                    //光线从包围盒内部发出，继续测试下一个轴
-                    continue;
-                }
+                const Real q = ray.origin[axis];
+                const bool isNegative = ray.isDirectionNegative[axis];
 
-                //计算光在当前轴和边界的两个交点
-                double t1 = (axisRange.min - q) / d;
-                double t2 = (axisRange.max - q) / d;
+                //计算光在当前轴和近、远边界的两个交点
+                const Real tNear = ((isNegative ? axisRange.max : axisRange.min) - q) * ray.invDirection[axis];
+                const Real tFar = ((isNegative ? axisRange.min : axisRange.max) - q) * ray.invDirection[axis];
 
                 //将currentRange限制到这两个交点的范围内
-                if (t1 < t2) {
-                    if (t1 > currentRange.min) currentRange.min = t1;
-                    if (t2 < currentRange.max) currentRange.max = t2;
-                } else {
-                    if (t2 > currentRange.min) currentRange.min = t2;
-                    if (t1 < currentRange.max) currentRange.max = t1;
-                }
+                if (tNear > currentRange.min) currentRange.min = tNear;
+                if (tFar < currentRange.max) currentRange.max = tFar;
 
                 if (!currentRange.isValid()) {
                     return false;
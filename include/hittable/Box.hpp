@@ -24,23 +24,28 @@ namespace renderer {
             }
         }
 
-        //使用AABB同款Slab-Test方法进行碰撞检测
+        //普通光线先计算方向的倒数
         bool hit(const Ray & ray, const Range & range, HitRecord & hitInfo) const {
-            double t_min = range.min;
-            double t_max = range.max;
+            return hit(TraversalRay(ray), range, hitInfo);
+        }
 
-            for (int i = 0; i < 3; i++) {
-                const double invD = 1.0 / ray.direction[i];
-                double t0 = (min[i] - ray.origin[i]) * invD;
-                double t1 = (max[i] - ray.origin[i]) * invD;
+        //使用AABB同款Slab-Test方法进行碰撞检测，BVH遍历时直接传入已缓存方向倒数的光线
+        bool hit(const TraversalRay & ray, const Range & range, HitRecord & hitInfo) const {
+            Real t_min = range.min;
+            Real t_max = range.max;
+            int entryAxis = 0; //t_min所在的slab，即光线进入盒子的面所在的轴
 
-                //如果光线方向为负，t0和t1会交换大小，这里确保 t0 是与较小平面相交的 t 值
-                if (invD < 0.0) {
-                    std::swap(t0, t1);
-                }
+            for (int i = 0; i < 3; i++) {
+                //根据方向的符号直接选取近平面和远平面，t0 是与较近平面相交的 t 值
+                const bool isNegative = ray.isDirectionNegative[i];
+                const Real t0 = ((isNegative ? max[i] : min[i]) - ray.origin[i]) * ray.invDirection[i];
+                const Real t1 = ((isNegative ? min[i] : max[i]) - ray.origin[i]) * ray.invDirection[i];
 
                 //更新总的 t 区间
-                t_min = std::max(t_min, t0);
+                if (t0 > t_min) {
+                    t_min = t0;
+                    entryAxis = i;
+                }
                 t_max = std::min(t_max, t1);
 
                 //如果区间不重叠，则不可能命中
@@ -51,7 +56,7 @@ namespace renderer {
 
             //此时，t_min 是光线进入盒子的时间点，t_max 是离开的时间点
             //我们只关心最近的有效撞击点
-            if (!range.inRange(t_min)) {
+            if (!range.surrounds(t_min)) {
                 //如果 t_min 不在有效范围内，可能 t_max 在（光线从盒子内部发出）
                 //但对于标准的光线追踪，我们通常只关心第一个交点
                 //这里可以根据需求决定是否测试 t_max
@@ -63,23 +68,13 @@ namespace renderer {
             hitInfo.hitPoint = ray.at(t_min);
             hitInfo.materialType = materialType;
             hitInfo.materialIndex = materialIndex;
+            hitInfo.primitiveType = PrimitiveType::BOX;
 
             //计算法向量
-            //找出撞击点在哪一个面上
+            //光线从entryAxis轴上的近平面进入盒子：方向为负时为最大值一侧的面，法向量朝正方向
+            //不比较碰撞点与各个面的距离，单精度构建中碰撞点的舍入误差可能超过固定的误差容限
             Vec3 outwardNormal;
-            if (std::abs(hitInfo.hitPoint[0] - min[0]) < FLOAT_VALUE_ZERO_EPSILON) {
-                outwardNormal = Vec3(-1, 0, 0);
-            } else if (std::abs(hitInfo.hitPoint[0] - max[0]) < FLOAT_VALUE_ZERO_EPSILON) {
-                outwardNormal = Vec3(1, 0, 0);
-            } else if (std::abs(hitInfo.hitPoint[1] - min[1]) < FLOAT_VALUE_ZERO_EPSILON) {
-                outwardNormal = Vec3(0, -1, 0);
-            } else if (std::abs(hitInfo.hitPoint[1] - max[1]) < FLOAT_VALUE_ZERO_EPSILON) {
-                outwardNormal = Vec3(0, 1, 0);
-            } else if (std::abs(hitInfo.hitPoint[2] - min[2]) < FLOAT_VALUE_ZERO_EPSILON) {
-                outwardNormal = Vec3(0, 0, -1);
-            } else {
-                outwardNormal = Vec3(0, 0, 1);
-            }
+            outwardNormal[entryAxis] = ray.isDirectionNegative[entryAxis] ? 1.0 : -1.0;
             hitInfo.normalVector = outwardNormal;
             hitInfo.hitFrontFace = Vec3::dot(ray.direction, outwardNormal) < 0.0;
 
@@ -12,10 +12,10 @@ namespace renderer {
         //物体属性
         Point3 q;
         Vec3 u, v;
-        double area;
+        Real area;
 
         Vec3 normalVector;
-        double planeD;
+        Real planeD;
 
         //材质属性
         MaterialType materialType;
@@ -32,7 +32,7 @@ namespace renderer {
             this->normalVector = Vec3::cross(u, v);
             this->area = normalVector.length();
             this->normalVector.unitize();
-            double sum = 0.0;
+            Real sum = 0.0;
             for (int i = 0; i < 3; i++) {
                 sum += normalVector[i] * q[i];
             }
@@ -42,18 +42,18 @@ namespace renderer {
         ~Parallelogram() = default;
 
         bool hit(const Ray & ray, const Range & range, HitRecord & hitInfo) const {
-            const double NDotD = Vec3::dot(normalVector, ray.direction);
+            const Real NDotD = Vec3::dot(normalVector, ray.direction);
             if (floatValueNearZero(NDotD)) {
                 return false;
             }
 
             //计算光线和四边形所在无限平面的交点参数t
-            double NDotP = 0.0;
+            Real NDotP = 0.0;
             for (int i = 0; i < 3; i++) {
                 NDotP += normalVector[i] * ray.origin[i];
             }
-            const double t = (planeD - NDotP) / NDotD;
-            if (!range.inRange(t)) {
+            const Real t = (planeD - NDotP) / NDotD;
+            if (!range.surrounds(t)) {
                 return false;
             }
 
@@ -61,14 +61,14 @@ namespace renderer {
             const Point3 intersection = ray.at(t);
             const Vec3 p = Point3::constructVector(q, intersection);
             const Vec3 normal = Vec3::cross(u, v);
-            const double denominator = normal.lengthSquare();
+            const Real denominator = normal.lengthSquare();
 
             if (floatValueNearZero(denominator)) {
                 return false;
             }
 
-            const double alpha = Vec3::dot(Vec3::cross(p, v), normal) / denominator;
-            const double beta = Vec3::dot(Vec3::cross(u, p), normal) / denominator;
+            const Real alpha = Vec3::dot(Vec3::cross(p, v), normal) / denominator;
+            const Real beta = Vec3::dot(Vec3::cross(u, p), normal) / denominator;
 
             const Range coefficientRange(0.0, 1.0);
             if (!coefficientRange.inRange(alpha) || !coefficientRange.inRange(beta)) {
@@ -80,7 +80,9 @@ namespace renderer {
             hitInfo.hitPoint = intersection;
             hitInfo.materialType = materialType;
             hitInfo.materialIndex = materialIndex;
-            hitInfo.uvPair = std::pair<double, double>(alpha, beta);
+            hitInfo.primitiveType = PrimitiveType::PARALLELOGRAM;
+            hitInfo.objectID = objectID;
+            hitInfo.uvPair = std::pair<Real, Real>(alpha, beta);
             hitInfo.hitFrontFace = Vec3::dot(ray.direction, normalVector) < 0.0;
             hitInfo.normalVector = hitInfo.hitFrontFace ? normalVector : -normalVector;
             return true;
@@ -92,27 +94,45 @@ namespace renderer {
             return {b1, b2};
         }
 
+        MaterialType getMaterialType() const {
+            return materialType;
+        }
+
+        size_t getMaterialIndex() const {
+            return materialIndex;
+        }
+
+        size_t getObjectID() const {
+            return objectID;
+        }
+
+        Real getArea() const {
+            return area;
+        }
+
         //获取四边形的中心点
         Point3 centroid() const {
             return q + 0.5 * u + 0.5 * v;
         }
 
-        double pdfValue(const Point3 &origin, const Vec3 &direction) const {
+        Real pdfValue(const Point3 &origin, const Vec3 &direction) const {
             HitRecord record;
             //检查方向有效性，确保从origin沿direction方向能够直接指向光源
-            if (!this->hit(Ray(origin, direction), Range(0.001, INFINITY), record)) {
+            if (!this->hit(Ray(origin, direction), Range(0.0, INFINITY), record)) {
                 return 0.0;
             }
 
             //从origin到q（光源上随机点）的向量为 record.t * direction
-            const double distanceSquare = (record.t * direction).lengthSquare();
+            const Real distanceSquare = (record.t * direction).lengthSquare();
             //向量点积公式：cos(theta) = a dot b / |a| |b|，其中|b| = 1
-            const double cosine = std::abs(Vec3::dot(direction, record.normalVector) / direction.length());
+            const Real cosine = std::abs(Vec3::dot(direction, record.normalVector) / direction.length());
             return distanceSquare / (cosine * area);
         }
 
-        Vec3 randomVector(const Point3 &origin) const {
-            const Point3 to = q + (randomDouble() * u) + (randomDouble() * v);
+        Vec3 randomVector(const Point3 &origin, Sampler & sampler) const {
+            double alpha, beta;
+            sampler.next2D(alpha, beta);
+            const Point3 to = q + (alpha * u) + (beta * v);
             return Point3::constructVector(origin, to);
         }
     };
@@ -12,7 +12,7 @@ namespace renderer {
     public:
         //物体属性
         Ray center;
-        double radius;
+        Real radius;
 
         //材质属性
         MaterialType materialType;
@@ -22,19 +22,19 @@ namespace renderer {
         size_t objectID;
 
         //将位于球体表面的点转换为二维坐标（u, v）
-        static std::pair<double, double> mapUVPair(const Point3 & surfacePoint) {
-            const double theta = std::acos(-surfacePoint[1]);
-            const double phi = std::atan2(-surfacePoint[2], surfacePoint[0]) + PI;
+        static std::pair<Real, Real> mapUVPair(const Point3 & surfacePoint) {
+            const Real theta = std::acos(-surfacePoint[1]);
+            const Real phi = std::atan2(-surfacePoint[2], surfacePoint[0]) + PI;
 
             return {phi / (2.0 * PI), theta / PI};
         }
 
         //构造静止球体
-        Sphere(size_t objectID, MaterialType materialType, size_t materialIndex, const Point3 & center, double radius) :
+        Sphere(size_t objectID, MaterialType materialType, size_t materialIndex, const Point3 & center, Real radius) :
             objectID(objectID), materialType(materialType), materialIndex(materialIndex), center(Ray(center, Vec3())), radius(radius > 0.0 ? radius : 0.0) {}
 
         //构造运动球体
-        Sphere(size_t objectID, MaterialType materialType, size_t materialIndex, const Point3 & from, const Point3 & to, double radius) :
+        Sphere(size_t objectID, MaterialType materialType, size_t materialIndex, const Point3 & from, const Point3 & to, Real radius) :
             objectID(objectID), materialType(materialType), materialIndex(materialIndex), center(Ray(from, Point3::constructVector(from, to))), radius(radius > 0.0 ? radius : 0.0) {}
 
         //构造包围盒
@@ -57,22 +57,22 @@ namespace renderer {
             //解一元二次方程，判断光线和球体的交点个数
             const Vec3 cq = Point3::constructVector(ray.origin, currentCenter);
             const Vec3 dir = ray.direction;
-            const double a = Vec3::dot(dir, dir);
-            const double b = -2.0 * Vec3::dot(cq, dir);
-            const double c = Vec3::dot(cq, cq) - radius * radius;
-            double delta = b * b - 4.0 * a * c;
+            const Real a = Vec3::dot(dir, dir);
+            const Real b = -2.0 * Vec3::dot(cq, dir);
+            const Real c = Vec3::dot(cq, cq) - radius * radius;
+            Real delta = b * b - 4.0 * a * c;
 
             if (delta < 0.0) return false;
             delta = sqrt(delta);
 
             //root1对应较小的t值，为距离摄像机较近的交点
-            const double root1 = (-b - delta) / (a * 2.0);
-            const double root2 = (-b + delta) / (a * 2.0);
+            const Real root1 = (-b - delta) / (a * 2.0);
+            const Real root2 = (-b + delta) / (a * 2.0);
 
-            double root;
-            if (range.inRange(root1)) { //先判断root1
+            Real root;
+            if (range.surrounds(root1)) { //先判断root1
                 root = root1;
-            } else if (range.inRange(root2)) {
+            } else if (range.surrounds(root2)) {
                 root = root2;
             } else {
                 return false; //两个根均不在允许范围内
@@ -83,6 +83,8 @@ namespace renderer {
             record.hitPoint = ray.at(root);
             record.materialType = materialType;
             record.materialIndex = materialIndex;
+            record.primitiveType = PrimitiveType::SPHERE;
+            record.objectID = objectID;
 
             //outwardNormal为球面向外的单位法向量，通过此向量和光线方向向量的点积符号判断光线撞击了球的内表面还是外表面
             //若点积小于0，则两向量夹角大于90度，两向量不同方向
@@ -96,33 +98,33 @@ namespace renderer {
             return true;
         }
 
-        Vec3 randomVector(const Point3 &origin) const {
+        Vec3 randomVector(const Point3 &origin, Sampler & sampler) const {
             //此计算方法只对静止球体有效
             const Vec3 direction = Point3::constructVector(origin, center.at(0.0));
-            const double distanceSquare = direction.lengthSquare();
+            const Real distanceSquare = direction.lengthSquare();
 
-            const double r1 = randomDouble();
-            const double r2 = randomDouble();
+            double r1, r2;
+            sampler.next2D(r1, r2);
 
-            const double phi = 2.0 * PI * r1;
-            const double z = 1.0 + r2 * (std::sqrt(1.0 - radius * radius / distanceSquare) - 1);
-            const double x = std::cos(phi) * std::sqrt(1.0 - z * z);
-            const double y = std::sin(phi) * std::sqrt(1.0 - z * z);
+            const Real phi = 2.0 * PI * r1;
+            const Real z = 1.0 + r2 * (std::sqrt(1.0 - radius * radius / distanceSquare) - 1);
+            const Real x = std::cos(phi) * std::sqrt(1.0 - z * z);
+            const Real y = std::sin(phi) * std::sqrt(1.0 - z * z);
 
             OrthonormalBase base(direction, 2);
             return base.transform(Vec3(x, y, z));
         }
 
-        double pdfValue(const Point3 &origin, const Vec3 &direction) const {
+        Real pdfValue(const Point3 &origin, const Vec3 &direction) const {
             //此计算方法只对静止球体有效
             HitRecord record;
-            if (!this->hit(Ray(origin, direction), Range(0.001, INFINITY), record)) {
+            if (!this->hit(Ray(origin, direction), Range(0.0, INFINITY), record)) {
                 return 0.0;
             }
 
-            const double distanceSquare = Point3::distanceSquare(origin, center.at(0.0));
-            const double cosThetaMax = std::sqrt(1.0 - radius * radius / distanceSquare);
-            const double solidAngle = 2.0 * PI * (1.0 - cosThetaMax);
+            const Real distanceSquare = Point3::distanceSquare(origin, center.at(0.0));
+            const Real cosThetaMax = std::sqrt(1.0 - radius * radius / distanceSquare);
+            const Real solidAngle = 2.0 * PI * (1.0 - cosThetaMax);
             return 1.0 / solidAngle;
         }
     };
@@ -6,10 +6,11 @@
 #include <hittable/Triangle.hpp>
 #include <hittable/Parallelogram.hpp>
 #include <hittable/Box.hpp>
+#include <hittable/TriangleMesh.hpp>
 
 namespace renderer {
     /*
-     * 使用4x4变换矩阵表示的变换类
+     * 使用仿射变换矩阵表示的变换类
      */
     class Transform {
     public:
@@ -18,10 +19,9 @@ namespace renderer {
         PrimitiveType primitiveType;
         size_t primitiveIndex;
 
-        //变换矩阵
-        Matrix transformMatrix;
-        Matrix transformInverse;
-        Matrix transformInverseTranspose;
+        //变换矩阵，法向量使用逆矩阵的转置变换
+        AffineMatrix transformMatrix;
+        AffineMatrix transformInverse;
 
         //变换后物体的包围盒和中心点
         BoundingBox transformedBoundingBox;
@@ -29,19 +29,18 @@ namespace renderer {
 
         Transform(const void * primitiveArray, PrimitiveType primitiveType, size_t primitiveIndex, const BoundingBox& boundingBox, const Point3& centroid,
                   const std::array<double, 3> & rotate = {}, const std::array<double, 3> & shift = {}, const std::array<double, 3> & scale = {1.0, 1.0, 1.0}) :
-                  primitiveArray(primitiveArray), primitiveType(primitiveType), primitiveIndex(primitiveIndex), transformMatrix(4, 4), transformInverse(4, 4), transformInverseTranspose(4, 4)
+                  primitiveArray(primitiveArray), primitiveType(primitiveType), primitiveIndex(primitiveIndex)
         {
             //M = T * R * S，平移 * 旋转 * 缩放
-            const auto m1 = Matrix::constructShiftMatrix(shift);
-            const auto m2 = Matrix::constructRotateMatrix(rotate);
-            const auto m3 = Matrix::constructScaleMatrix(scale);
+            const auto m1 = AffineMatrix::constructShiftMatrix(shift);
+            const auto m2 = AffineMatrix::constructRotateMatrix(rotate);
+            const auto m3 = AffineMatrix::constructScaleMatrix(scale);
             transformMatrix = m1 * m2 * m3;
             transformInverse = transformMatrix.inverse();
-            transformInverseTranspose = transformInverse.transpose();
 
             //变换包围盒和中心点
             this->transformedBoundingBox = boundingBox.transformBoundingBox(transformMatrix);
-            this->transformedCentroid = (transformMatrix * Matrix::toMatrix(centroid.toVector(), 1.0)).toPoint();
+            this->transformedCentroid = transformMatrix.transformPoint(centroid);
         }
         ~Transform() = default;
 
@@ -50,17 +49,8 @@ namespace renderer {
          */
         bool hit(const Ray &ray, const Range &range, HitRecord &record) const
         {
-            /*
-             * 将世界空间光线变换到物体的局部空间：使用逆矩阵分别对ray的起点和方向向量进行变换
-             * 只有左矩阵的列数和右矩阵的行数相同的矩阵才能相乘，则将三维点变为1列4行的列向量
-             */
-            auto rayOrigin = Matrix::toMatrix(ray.origin.toVector(), 1.0);
-            auto rayDirection = Matrix::toMatrix(ray.direction, 0.0);
-            rayOrigin = transformInverse * rayOrigin;
-            rayDirection = transformInverse * rayDirection;
-
-            //构造变换后的光线
-            const Ray transformed(rayOrigin.toPoint(), rayDirection.toPoint().toVector(), ray.time);
+            //将世界空间光线变换到物体的局部空间：使用逆矩阵分别对ray的起点和方向向量进行变换
+            const Ray transformed(transformInverse.transformPoint(ray.origin), transformInverse.transformVector(ray.direction), ray.time);
 
             //在物体空间中对变换后的光线进行相交测试
             bool isHit = false;
@@ -94,6 +84,13 @@ namespace renderer {
                     }
                     break;
                 }
+                case PrimitiveType::MESH: {
+                    const TriangleMesh * meshes = static_cast<const TriangleMesh *>(primitiveArray);
+                    if (meshes[primitiveIndex].hit(transformed, range, record)) {
+                        isHit = true;
+                    }
+                    break;
+                }
                 default:;
             }
 
@@ -102,16 +99,12 @@ namespace renderer {
             } else {
                 //如果有碰撞，则将将局部空间的命中记录变换回世界空间，t值和uv坐标不需要变换
                 //变换碰撞点
-                auto point = Matrix::toMatrix(record.hitPoint.toVector(), 1.0);
-                point = transformMatrix * point;
-                record.hitPoint = point.toPoint();
+                record.hitPoint = transformMatrix.transformPoint(record.hitPoint);
 
-                //使用逆转置变换矩阵变换法向量
-                //向量不受平移影响，将w分量设置为0可完成此目的
-                auto normal = Matrix::toMatrix(record.normalVector, 0.0);
-                normal = transformInverseTranspose * normal;
-                record.normalVector = normal.toPoint().toVector().unitVector();
+                //使用逆转置变换矩阵变换法向量，向量不受平移影响
+                record.normalVector = transformInverse.transposeTransformVector(record.normalVector).unitVector();
                 record.hitFrontFace = Vec3::dot(ray.direction, record.normalVector) < 0.0;
+                record.primitiveType = PrimitiveType::TRANSFORM; //变换后的物体不是原物体，不能按原物体的下标查找
                 return true;
             }
         }
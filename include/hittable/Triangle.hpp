@@ -80,7 +80,7 @@ namespace renderer {
         bool hit(const Ray & ray, const Range & range, HitRecord & record) const {
             const Vec3 h = ray.direction.cross(e2); //h = d x e2
             //系数行列式
-            const double detA = e1.dot(h); //detA = e1 * (d x e2)
+            const Real detA = e1.dot(h); //detA = e1 * (d x e2)
 
             //行列式为0，说明方程组无解或有无穷解（光线和三角形平行或有无数个交点）
             if (floatValueNearZero(detA)) {
@@ -91,7 +91,7 @@ namespace renderer {
 
             //计算未知数U并检查
             const Range coefficientRange(0.0, 1.0);
-            const double u = s.dot(h) / detA; // u = (s · h) / det
+            const Real u = s.dot(h) / detA; // u = (s · h) / det
             if (!coefficientRange.inRange(u)) {
                 return false;
             }
@@ -99,19 +99,21 @@ namespace renderer {
             const Vec3 q = s.cross(e1);  // q = s × e1
 
             //计算未知数V并检查
-            const double v = ray.direction.dot(q) / detA; // v = (D · q) / det
+            const Real v = ray.direction.dot(q) / detA; // v = (D · q) / det
             if (!coefficientRange.inRange(v) || u + v > 1.0) {
                 return false;
             }
 
             //满足相交条件，计算碰撞参数
             record.t = e2.dot(q) / detA; // t = (e2 · q) / det
-            if (!range.inRange(record.t)) {
+            if (!range.surrounds(record.t)) {
                 return false;
             }
             record.hitPoint = ray.at(record.t);
             record.materialType = materialType;
             record.materialIndex = materialIndex;
+            record.primitiveType = PrimitiveType::TRIANGLE;
+            record.objectID = objectID;
             record.uvPair = {u, v};
 
             //交点法向量为三个顶点法向量的插值平滑
@@ -0,0 +1,199 @@
+#ifndef RENDERERBUILD_TRIANGLEMESH_HPP
+#define RENDERERBUILD_TRIANGLEMESH_HPP
+
+#include <box/BVHNode.hpp>
+
+namespace renderer {
+    /*
+     * 三角形网格类
+     * 所有三角形共享顶点位置、法向量和UV数组，通过32位索引缓冲区引用顶点，顶点数据使用float存储
+     * 顶点数组和索引数组由调用者持有，网格只保存指针（同Transform引用图元数组的方式）
+     * 整个网格在场景BVH中只占用一个图元，网格内部使用独立的宽BVH加速三角形的相交测试
+     * 内部BVH由BVHTree::constructMeshBVH构建，通过bindBVH绑定后才能进行相交测试
+     */
+    class TriangleMesh {
+    private:
+        //顶点数据
+        const float * positions; //顶点位置，每个顶点3个分量
+        const float * normals;   //顶点法向量，每个顶点3个分量，为nullptr时使用面法向量
+        const float * uvs;       //顶点纹理坐标，每个顶点2个分量，为nullptr时使用重心坐标
+        const Uint32 * indices;  //索引缓冲区，每个三角形3个顶点下标
+        Uint32 vertexCount;
+        Uint32 triangleCount;
+
+        //内部BVH：叶子节点引用triangleOrder中的区间，triangleOrder的元素为三角形下标
+        const BVHWideNode * nodes;
+        const Uint32 * triangleOrder;
+
+        //材质属性，网格中的所有三角形使用相同材质
+        MaterialType materialType;
+        size_t materialIndex;
+
+        //所有顶点的包围盒
+        BoundingBox boundingBox;
+
+        Point3 vertex(Uint32 index) const {
+            const float * p = positions + 3 * static_cast<size_t>(index);
+            return Point3(p[0], p[1], p[2]);
+        }
+
+        Vec3 vertexNormal(Uint32 index) const {
+            const float * n = normals + 3 * static_cast<size_t>(index);
+            return Vec3(n[0], n[1], n[2]);
+        }
+
+        //单个三角形的相交测试，计算方式同Triangle::hit
+        bool hitTriangle(Uint32 triangle, const Ray & ray, const Range & range, HitRecord & record) const {
+            const Uint32 * triangleIndices = indices + 3 * static_cast<size_t>(triangle);
+            const Point3 p0 = vertex(triangleIndices[0]);
+            const Vec3 e1 = Point3::constructVector(p0, vertex(triangleIndices[1]));
+            const Vec3 e2 = Point3::constructVector(p0, vertex(triangleIndices[2]));
+
+            const Vec3 h = ray.direction.cross(e2);
+            const Real detA = e1.dot(h);
+            if (floatValueNearZero(detA)) {
+                return false;
+            }
+
+            const Vec3 s = Point3::constructVector(p0, ray.origin);
+            const Range coefficientRange(0.0, 1.0);
+            const Real u = s.dot(h) / detA;
+            if (!coefficientRange.inRange(u)) {
+                return false;
+            }
+
+            const Vec3 q = s.cross(e1);
+            const Real v = ray.direction.dot(q) / detA;
+            if (!coefficientRange.inRange(v) || u + v > 1.0) {
+                return false;
+            }
+
+            const Real t = e2.dot(q) / detA;
+            if (!range.surrounds(t)) {
+                return false;
+            }
+            record.t = t;
+            record.hitPoint = ray.at(t);
+            record.materialType = materialType;
+            record.materialIndex = materialIndex;
+            record.primitiveType = PrimitiveType::MESH;
+
+            //有纹理坐标时插值顶点的纹理坐标，否则同Triangle使用重心坐标
+            const Real w = 1.0 - u - v;
+            if (uvs != nullptr) {
+                const float * uv0 = uvs + 2 * static_cast<size_t>(triangleIndices[0]);
+                const float * uv1 = uvs + 2 * static_cast<size_t>(triangleIndices[1]);
+                const float * uv2 = uvs + 2 * static_cast<size_t>(triangleIndices[2]);
+                record.uvPair = {w * uv0[0] + u * uv1[0] + v * uv2[0], w * uv0[1] + u * uv1[1] + v * uv2[1]};
+            } else {
+                record.uvPair = {u, v};
+            }
+
+            //有顶点法向量时插值平滑，否则使用面法向量
+            const Vec3 n = normals != nullptr ?
+                    (w * vertexNormal(triangleIndices[0]) + u * vertexNormal(triangleIndices[1]) + v * vertexNormal(triangleIndices[2])).unitVector() :
+                    Vec3::cross(e1, e2).unitVector();
+            record.hitFrontFace = Vec3::dot(ray.direction, n) < 0.0;
+            record.normalVector = record.hitFrontFace ? n : -n;
+            return true;
+        }
+
+    public:
+        TriangleMesh(MaterialType materialType, size_t materialIndex,
+                     const float * positions, Uint32 vertexCount, const Uint32 * indices, Uint32 triangleCount,
+                     const float * normals = nullptr, const float * uvs = nullptr) :
+                positions(positions), normals(normals), uvs(uvs), indices(indices), vertexCount(vertexCount), triangleCount(triangleCount),
+                nodes(nullptr), triangleOrder(nullptr), materialType(materialType), materialIndex(materialIndex)
+        {
+            if (triangleCount == 0 || positions == nullptr || indices == nullptr) {
+                throw std::runtime_error("Triangle mesh has no geometry!");
+            }
+            for (size_t i = 0; i < 3 * static_cast<size_t>(triangleCount); i++) {
+                if (indices[i] >= vertexCount) {
+                    throw std::runtime_error("Triangle mesh index out of range!");
+                }
+            }
+
+            Point3 min(INFINITY, INFINITY, INFINITY);
+            Point3 max(-INFINITY, -INFINITY, -INFINITY);
+            for (Uint32 i = 0; i < vertexCount; i++) {
+                const Point3 p = vertex(i);
+                min = Point3::min(min, p);
+                max = Point3::max(max, p);
+            }
+            boundingBox = BoundingBox(min, max);
+        }
+
+        // ====== 对象操作函数 ======
+
+        //绑定内部BVH，数组由调用者持有
+        void bindBVH(const BVHWideNode * bvhNodes, const Uint32 * bvhTriangleOrder) {
+            nodes = bvhNodes;
+            triangleOrder = bvhTriangleOrder;
+        }
+
+        bool hasBVH() const {
+            return nodes != nullptr && triangleOrder != nullptr;
+        }
+
+        Uint32 getTriangleCount() const {
+            return triangleCount;
+        }
+
+        //单个三角形的包围盒和重心，用于构建内部BVH
+        BoundingBox triangleBoundingBox(Uint32 triangle) const {
+            const Uint32 * triangleIndices = indices + 3 * static_cast<size_t>(triangle);
+            const Point3 p0 = vertex(triangleIndices[0]), p1 = vertex(triangleIndices[1]), p2 = vertex(triangleIndices[2]);
+            return {Point3::min(Point3::min(p0, p1), p2), Point3::max(Point3::max(p0, p1), p2)};
+        }
+
+        Point3 triangleCentroid(Uint32 triangle) const {
+            const Uint32 * triangleIndices = indices + 3 * static_cast<size_t>(triangle);
+            const Point3 p0 = vertex(triangleIndices[0]), p1 = vertex(triangleIndices[1]), p2 = vertex(triangleIndices[2]);
+            Point3 ret;
+            for (size_t i = 0; i < 3; i++) {
+                ret[i] = (p0[i] + p1[i] + p2[i]) / 3.0;
+            }
+            return ret;
+        }
+
+        BoundingBox constructBoundingBox() const {
+            return boundingBox;
+        }
+
+        //使用包围盒中心作为网格的重心
+        Point3 centroid() const {
+            return Point3(
+                    0.5 * (boundingBox[0].min + boundingBox[0].max),
+                    0.5 * (boundingBox[1].min + boundingBox[1].max),
+                    0.5 * (boundingBox[2].min + boundingBox[2].max)
+            );
+        }
+
+        //普通光线先计算方向的倒数（网格被Transform引用时）
+        bool hit(const Ray & ray, const Range & range, HitRecord & record) const {
+            return hit(TraversalRay(ray), range, record);
+        }
+
+        //遍历内部BVH，叶子中的三角形依次进行相交测试
+        bool hit(const TraversalRay & ray, const Range & range, HitRecord & record) const {
+            Range currentRange(range);
+            auto leafFunction = [&](Uint32 startIndex, Uint32 count) {
+                HitRecord tempRecord;
+                bool isHit = false;
+                traversalStatisticsAdd(meshTriangleTestCount, count);
+                for (Uint32 i = 0; i < count; i++) {
+                    if (hitTriangle(triangleOrder[startIndex + i], ray, currentRange, tempRecord)) {
+                        isHit = true;
+                        currentRange.max = tempRecord.t;
+                        record = tempRecord;
+                    }
+                }
+                return isHit;
+            };
+            return BVHWideNode::traverse(nodes, ray, currentRange, leafFunction);
+        }
+    };
+}
+
+#endif //RENDERERBUILD_TRIANGLEMESH_HPP
@@ -13,6 +13,10 @@ namespace renderer {
         explicit DiffuseLight(const Color3 & lightColor) : light(lightColor) {}
         ~DiffuseLight() = default;
 
+        const Color3 & getLightColor() const {
+            return light;
+        }
+
         Color3 emitted(const Ray & ray, const HitRecord & record) const {
             //仅当光线和法线同向时返回光源颜色
             if (record.hitFrontFace) {
@@ -11,17 +11,17 @@ namespace renderer {
     class Metal {
     private:
         Color3 albedo;
-        double fuzz;
+        Real fuzz;
 
     public:
-        explicit Metal(const Color3 & albedo = Color3(1.0, 1.0, 1.0), double fuzz = 0.0) :
+        explicit Metal(const Color3 & albedo = Color3(1.0, 1.0, 1.0), Real fuzz = 0.0) :
                 albedo(albedo), fuzz(fuzz)
         {
             this->fuzz = Range(0.0, 1.0).clamp(fuzz);
         }
 
         //金属材质不吸收光线，完全反射光线
-        bool scatter(const Ray & in, const HitRecord & record, Color3 & attenuation, Ray & out) const {
+        bool scatter(const Ray & in, const HitRecord & record, Color3 & attenuation, Ray & out, Sampler & sampler) const {
             //计算反射光线方向向量（单位向量）
             const Vec3 v = in.direction;
             const Vec3 n = record.normalVector;
@@ -29,11 +29,11 @@ namespace renderer {
 
             //应用反射扰动：在距离物体表面1单位处随机选取单位向量和反射向量相加，形成随机扰动
             if (fuzz > 0.0) {
-                reflectDirection += fuzz * Vec3::randomSpaceVector(1.0);
+                reflectDirection += fuzz * Vec3::randomSpaceVector(1.0, sampler);
             }
 
             //构建反射光线，光线的时间属性不随传播而改变
-            out = Ray(record.hitPoint, reflectDirection, in.time);
+            out = Ray::spawn(in, record, reflectDirection);
             attenuation = albedo;
 
             //防止由于计算精度导致out方向向内。使用点积检查反射光线是否和物体外法线的同侧，仅当二者同侧时有效
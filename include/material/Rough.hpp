@@ -35,7 +35,7 @@ namespace renderer {
 //            return true;
 //        }
 //
-//        double scatterPDF(const Ray & in, const HitRecord & record, const Ray & out) const {
+//        Real scatterPDF(const Ray & in, const HitRecord & record, const Ray & out) const {
 //            return std::max(0.0, Vec3::dot(record.normalVector, out.direction.unitVector()) / PI);
 //        }
 
@@ -48,8 +48,8 @@ namespace renderer {
         }
 
         //计算渲染方程中的余弦项
-        double cosTheta(const Ray & out, const HitRecord & record) const {
-            return std::max(0.0, Vec3::dot(record.normalVector, out.direction.unitVector()));
+        Real cosTheta(const Ray & out, const HitRecord & record) const {
+            return std::max<Real>(0.0, Vec3::dot(record.normalVector, out.direction.unitVector()));
             //return Vec3::dot(record.normalVector, out.direction.unitVector());
         }
     };
@@ -17,12 +17,12 @@ namespace renderer {
 
         ~CosinePDF() = default;
 
-        Vec3 generate() const {
+        Vec3 generate(Sampler & sampler) const {
             //将生成的局部空间向量（randomCosineVector）变换到世界空间
-            return base.transform(Vec3::randomCosineVector(2, true));
+            return base.transform(Vec3::randomCosineVector(2, true, sampler));
         }
 
-        double value(const Vec3 &vec) const {
+        Real value(const Vec3 &vec) const {
             //保证概率密度不为负
             return std::max(0.0, Vec3::dot(vec.unitVector(), base[2]) / PI);
         }
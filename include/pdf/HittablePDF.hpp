@@ -11,7 +11,7 @@
 namespace renderer {
     /*
      * 直接向物体采样的PDF
-     * origin为光线的起点（当前碰撞点）
+     * 只记录物体索引，光线的起点（当前碰撞点）origin在采样和计算概率密度时传入，每个物体的PDF在渲染开始前构造一次
      */
     class HittablePDF {
     private:
@@ -19,30 +19,27 @@ namespace renderer {
         PrimitiveType primitiveType;
         size_t primitiveIndex;
 
-        //当前碰撞点
-        Point3 origin;
-
     public:
-        HittablePDF(PrimitiveType primitiveType = PrimitiveType::SPHERE, size_t primitiveIndex = 0, const Point3 & origin = Point3()) :
-                primitiveType(primitiveType), primitiveIndex(primitiveIndex), origin(origin) {}
+        HittablePDF(PrimitiveType primitiveType = PrimitiveType::SPHERE, size_t primitiveIndex = 0) :
+                primitiveType(primitiveType), primitiveIndex(primitiveIndex) {}
 
         ~HittablePDF() = default;
 
-        Vec3 generate(const Sphere * spheres, const Parallelogram * parallelograms) const {
+        Vec3 generate(const Point3 & origin, const Sphere * spheres, const Parallelogram * parallelograms, Sampler & sampler) const {
             //从碰撞点指向物体上任意一点
             switch (primitiveType) {
                 case PrimitiveType::SPHERE:
-                    return spheres[primitiveIndex].randomVector(origin);
+                    return spheres[primitiveIndex].randomVector(origin, sampler);
                 case PrimitiveType::PARALLELOGRAM:
-                    return parallelograms[primitiveIndex].randomVector(origin);
+                    return parallelograms[primitiveIndex].randomVector(origin, sampler);
                     //TODO Triangle, Transform的randomVector和pdfValue方法实现
                 default:
                     return Vec3();
             }
         }
 
-        double value(const Sphere * spheres, const Parallelogram * parallelograms,
-                     const Vec3 &vec) const {
+        Real value(const Point3 & origin, const Sphere * spheres, const Parallelogram * parallelograms,
+                   const Vec3 &vec) const {
             const Vec3 unitVec = vec.unitVector();
             switch (primitiveType) {
                 case PrimitiveType::SPHERE:
@@ -0,0 +1,147 @@
+#ifndef RENDERERBUILD_LIGHTSAMPLER_HPP
+#define RENDERERBUILD_LIGHTSAMPLER_HPP
+
+#include <pdf/HittablePDF.hpp>
+#include <material/DiffuseLight.hpp>
+
+namespace renderer {
+    /*
+     * 光源采样器，在渲染开始前由CPU构建
+     * 从直接采样物体列表中选出材质为DIFFUSE_LIGHT的物体作为光源，按光源功率（亮度 x 表面积）构建别名表
+     * 每次光源采样只需O(1)时间选择一个光源，并且只计算被选中光源的PDF，与光源数量无关
+     *
+     * 光源采样的概率密度为 P(选中光源) x 该光源的立体角PDF
+     * 方向采样击中光源时，通过碰撞记录中的图元类型和物体下标查找被击中的光源，计算多重重要性采样的权重
+     */
+    class LightSampler {
+    private:
+        struct LightInfo {
+            PrimitiveType primitiveType;
+            size_t primitiveIndex; //在直接采样物体数组中的下标
+
+            LightInfo(PrimitiveType primitiveType, size_t primitiveIndex) : primitiveType(primitiveType), primitiveIndex(primitiveIndex) {}
+        };
+
+        std::vector<LightInfo> lights;
+
+        //别名表：随机选择第i列，以aliasProbabilities[i]的概率选中光源i，否则选中aliasIndices[i]
+        std::vector<double> aliasProbabilities;
+        std::vector<Uint32> aliasIndices;
+
+        //每个光源被选中的概率
+        std::vector<double> lightPMFs;
+
+        //物体下标到光源下标的映射，不是光源的物体为-1
+        std::vector<int> sphereLightIndices;
+        std::vector<int> parallelogramLightIndices;
+
+        //Vose算法构建别名表，所有光源功率均为0时按均匀概率选择
+        void buildAliasTable(const std::vector<double> & powers) {
+            const size_t count = powers.size();
+            double totalPower = 0.0;
+            for (double power : powers) {
+                totalPower += power;
+            }
+
+            lightPMFs.resize(count);
+            aliasProbabilities.assign(count, 1.0);
+            aliasIndices.resize(count);
+
+            //将每个光源的概率缩放count倍，小于1的列由大于1的列补齐
+            std::vector<double> scaled(count);
+            std::vector<Uint32> small, large;
+            for (size_t i = 0; i < count; i++) {
+                lightPMFs[i] = totalPower > 0.0 ? powers[i] / totalPower : 1.0 / static_cast<double>(count);
+                scaled[i] = lightPMFs[i] * static_cast<double>(count);
+                aliasIndices[i] = static_cast<Uint32>(i);
+                (scaled[i] < 1.0 ? small : large).push_back(static_cast<Uint32>(i));
+            }
+            while (!small.empty() && !large.empty()) {
+                const Uint32 s = small.back(); small.pop_back();
+                const Uint32 l = large.back(); large.pop_back();
+                aliasProbabilities[s] = scaled[s];
+                aliasIndices[s] = l;
+                scaled[l] -= 1.0 - scaled[s];
+                (scaled[l] < 1.0 ? small : large).push_back(l);
+            }
+            //剩余列的概率由于浮点误差略小于或大于1，直接视为1
+        }
+
+        static void registerLight(std::vector<int> & lookup, size_t objectID, size_t lightIndex) {
+            if (lookup.size() <= objectID) {
+                lookup.resize(objectID + 1, -1);
+            }
+            lookup[objectID] = static_cast<int>(lightIndex);
+        }
+
+    public:
+        LightSampler(const Sphere * spheres, size_t sphereCount,
+                     const Parallelogram * parallelograms, size_t parallelogramCount,
+                     const DiffuseLight * lightMaterials)
+        {
+            std::vector<double> powers;
+            for (size_t i = 0; i < sphereCount; i++) {
+                const Sphere & sphere = spheres[i];
+                if (sphere.materialType != MaterialType::DIFFUSE_LIGHT) continue;
+                registerLight(sphereLightIndices, sphere.objectID, lights.size());
+                lights.emplace_back(PrimitiveType::SPHERE, i);
+                powers.push_back(std::max<double>(0.0, lightMaterials[sphere.materialIndex].getLightColor().luminance()) *
+                                 4.0 * PI * sphere.radius * sphere.radius);
+            }
+            for (size_t i = 0; i < parallelogramCount; i++) {
+                const Parallelogram & parallelogram = parallelograms[i];
+                if (parallelogram.getMaterialType() != MaterialType::DIFFUSE_LIGHT) continue;
+                registerLight(parallelogramLightIndices, parallelogram.getObjectID(), lights.size());
+                lights.emplace_back(PrimitiveType::PARALLELOGRAM, i);
+                powers.push_back(std::max<double>(0.0, lightMaterials[parallelogram.getMaterialIndex()].getLightColor().luminance()) *
+                                 parallelogram.getArea());
+            }
+            buildAliasTable(powers);
+        }
+
+        // ====== 对象操作函数 ======
+
+        size_t lightCount() const {
+            return lights.size();
+        }
+
+        //选择一个光源，返回光源下标，光源数量必须大于0
+        size_t sample(Sampler & sampler) const {
+            const double u = sampler.nextDouble() * static_cast<double>(lights.size());
+            const size_t column = std::min(static_cast<size_t>(u), lights.size() - 1);
+            return u - static_cast<double>(column) < aliasProbabilities[column] ? column : aliasIndices[column];
+        }
+
+        //从origin向光源上的随机点采样一个方向
+        Vec3 generate(size_t lightIndex, const Point3 & origin,
+                      const Sphere * spheres, const Parallelogram * parallelograms, Sampler & sampler) const {
+            const LightInfo & light = lights[lightIndex];
+            return HittablePDF(light.primitiveType, light.primitiveIndex).generate(origin, spheres, parallelograms, sampler);
+        }
+
+        //光源采样策略在origin处沿direction方向的概率密度，只计算指定光源
+        Real value(size_t lightIndex, const Point3 & origin,
+                   const Sphere * spheres, const Parallelogram * parallelograms, const Vec3 & direction) const {
+            const LightInfo & light = lights[lightIndex];
+            return lightPMFs[lightIndex] * HittablePDF(light.primitiveType, light.primitiveIndex).value(origin, spheres, parallelograms, direction);
+        }
+
+        //根据碰撞记录查找被击中的光源，被击中的物体不在光源列表中时返回-1
+        int findLight(const HitRecord & record) const {
+            const std::vector<int> * lookup;
+            switch (record.primitiveType) {
+                case PrimitiveType::SPHERE:
+                    lookup = &sphereLightIndices;
+                    break;
+                case PrimitiveType::PARALLELOGRAM:
+                    lookup = &parallelogramLightIndices;
+                    break;
+                default:
+                    return -1;
+            }
+            return record.objectID < lookup->size() ? (*lookup)[record.objectID] : -1;
+        }
+    };
+}
+
+#endif //RENDERERBUILD_LIGHTSAMPLER_HPP
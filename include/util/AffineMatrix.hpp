@@ -0,0 +1,156 @@
+#ifndef RENDERERBUILD_AFFINEMATRIX_HPP
+#define RENDERERBUILD_AFFINEMATRIX_HPP
+
+#include <basic/Point3.hpp>
+
+namespace renderer {
+    /*
+     * 3行4列仿射变换矩阵，省略4x4矩阵恒为(0, 0, 0, 1)的最后一行
+     * 左侧3x3为线性部分（旋转、缩放），最后一列为平移
+     * 数据为定长数组，没有堆内存和析构函数，可以直接按字节拷贝到GPU
+     */
+    struct AffineMatrix {
+        Real data[3][4];
+
+        // ====== 对象操作函数 ======
+
+        //变换空间点，受平移影响
+        Point3 transformPoint(const Point3 & point) const {
+            Point3 ret;
+            for (int i = 0; i < 3; i++) {
+                ret[i] = data[i][0] * point[0] + data[i][1] * point[1] + data[i][2] * point[2] + data[i][3];
+            }
+            return ret;
+        }
+
+        //变换向量，不受平移影响
+        Vec3 transformVector(const Vec3 & vec) const {
+            Vec3 ret;
+            for (int i = 0; i < 3; i++) {
+                ret[i] = data[i][0] * vec[0] + data[i][1] * vec[1] + data[i][2] * vec[2];
+            }
+            return ret;
+        }
+
+        /*
+         * 使用线性部分的转置变换向量
+         * 法向量需要使用逆转置矩阵变换，对逆矩阵调用此函数即可，不需要单独存储逆转置矩阵
+         */
+        Vec3 transposeTransformVector(const Vec3 & vec) const {
+            Vec3 ret;
+            for (int i = 0; i < 3; i++) {
+                ret[i] = data[0][i] * vec[0] + data[1][i] * vec[1] + data[2][i] * vec[2];
+            }
+            return ret;
+        }
+
+        //矩阵乘法，结果为先应用right再应用当前矩阵的变换
+        AffineMatrix operator*(const AffineMatrix & right) const {
+            AffineMatrix ret {};
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 4; j++) {
+                    ret.data[i][j] = data[i][0] * right.data[0][j] + data[i][1] * right.data[1][j] + data[i][2] * right.data[2][j];
+                }
+                ret.data[i][3] += data[i][3];
+            }
+            return ret;
+        }
+
+        //求逆矩阵：线性部分使用伴随矩阵求逆，平移部分为-A^-1 * t
+        AffineMatrix inverse() const {
+            const Real (&a)[4] = data[0];
+            const Real (&b)[4] = data[1];
+            const Real (&c)[4] = data[2];
+
+            //代数余子式
+            const Real c00 = b[1] * c[2] - b[2] * c[1];
+            const Real c01 = b[2] * c[0] - b[0] * c[2];
+            const Real c02 = b[0] * c[1] - b[1] * c[0];
+            const Real det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+            if (det == 0.0) {
+                throw std::runtime_error("Affine matrix is singular!");
+            }
+            const Real invDet = 1.0 / det;
+
+            AffineMatrix ret {};
+            ret.data[0][0] = c00 * invDet;
+            ret.data[0][1] = (a[2] * c[1] - a[1] * c[2]) * invDet;
+            ret.data[0][2] = (a[1] * b[2] - a[2] * b[1]) * invDet;
+            ret.data[1][0] = c01 * invDet;
+            ret.data[1][1] = (a[0] * c[2] - a[2] * c[0]) * invDet;
+            ret.data[1][2] = (a[2] * b[0] - a[0] * b[2]) * invDet;
+            ret.data[2][0] = c02 * invDet;
+            ret.data[2][1] = (a[1] * c[0] - a[0] * c[1]) * invDet;
+            ret.data[2][2] = (a[0] * b[1] - a[1] * b[0]) * invDet;
+            for (int i = 0; i < 3; i++) {
+                ret.data[i][3] = -(ret.data[i][0] * a[3] + ret.data[i][1] * b[3] + ret.data[i][2] * c[3]);
+            }
+            return ret;
+        }
+
+        // ====== 静态操作函数 ======
+
+        static AffineMatrix identity() {
+            return {{
+                    {1.0, 0.0, 0.0, 0.0},
+                    {0.0, 1.0, 0.0, 0.0},
+                    {0.0, 0.0, 1.0, 0.0}
+            }};
+        }
+
+        //构造三维平移矩阵
+        static AffineMatrix constructShiftMatrix(const std::array<double, 3> & shift) {
+            return {{
+                    {1.0, 0.0, 0.0, static_cast<Real>(shift[0])},
+                    {0.0, 1.0, 0.0, static_cast<Real>(shift[1])},
+                    {0.0, 0.0, 1.0, static_cast<Real>(shift[2])}
+            }};
+        }
+
+        //构造三维缩放矩阵
+        static AffineMatrix constructScaleMatrix(const std::array<double, 3> & scale) {
+            return {{
+                    {static_cast<Real>(scale[0]), 0.0, 0.0, 0.0},
+                    {0.0, static_cast<Real>(scale[1]), 0.0, 0.0},
+                    {0.0, 0.0, static_cast<Real>(scale[2]), 0.0}
+            }};
+        }
+
+        //构造三维旋转矩阵，0，1，2表示x，y，z轴
+        static AffineMatrix constructRotateMatrix(Real degree, int axis) {
+            const Real theta = static_cast<Real>(degreeToRadian(degree));
+            const Real sinTheta = std::sin(theta);
+            const Real cosTheta = std::cos(theta);
+            switch (axis) {
+                case 0:
+                    return {{
+                            {1.0, 0.0, 0.0, 0.0},
+                            {0.0, cosTheta, -sinTheta, 0.0},
+                            {0.0, sinTheta, cosTheta, 0.0}
+                    }};
+                case 1:
+                    return {{
+                            {cosTheta, 0.0, sinTheta, 0.0},
+                            {0.0, 1.0, 0.0, 0.0},
+                            {-sinTheta, 0.0, cosTheta, 0.0}
+                    }};
+                case 2:
+                    return {{
+                            {cosTheta, -sinTheta, 0.0, 0.0},
+                            {sinTheta, cosTheta, 0.0, 0.0},
+                            {0.0, 0.0, 1.0, 0.0}
+                    }};
+                default:
+                    throw std::runtime_error("Invalid axis index!");
+            }
+        }
+
+        static AffineMatrix constructRotateMatrix(const std::array<double, 3> & rotate) {
+            return constructRotateMatrix(static_cast<Real>(rotate[0]), 0) *
+                   constructRotateMatrix(static_cast<Real>(rotate[1]), 1) *
+                   constructRotateMatrix(static_cast<Real>(rotate[2]), 2);
+        }
+    };
+}
+
+#endif //RENDERERBUILD_AFFINEMATRIX_HPP
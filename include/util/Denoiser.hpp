@@ -1,7 +1,7 @@
 #ifndef RENDERERBUILD_DENOISER_HPP
 #define RENDERERBUILD_DENOISER_HPP
 
-#include <basic/Color3.hpp>
+#include <util/FrameBuffer.hpp>
 #include <OpenImageDenoise/oidn.hpp>
 
 namespace renderer {
@@ -17,12 +17,12 @@ namespace renderer {
         oidn::BufferRef normalBuffer; //辅助信息：表面法线
         oidn::BufferRef albedoBuffer; //辅助信息：衰减颜色
 
-    public:
         //缓冲区数组原始指针
         float * colorPtr;
         float * normalPtr;
         float * albedoPtr;
 
+    public:
         Denoiser(Uint32 windowWidth, Uint32 windowHeight) : windowWidth(windowWidth), windowHeight(windowHeight) {
             device = oidn::newDevice();
             device.commit();
@@ -42,9 +42,28 @@ namespace renderer {
         }
         ~Denoiser() = default;
 
-        //降噪并将结果写入到颜色内存
-        void denoiseAndWrite(Uint32 * pixels, const SDL_PixelFormat * format) {
+        //降噪并将结果写回帧缓冲区的颜色数组，反照率和法向量保持不变，降噪失败时颜色保持不变并返回false
+        bool denoise(FrameBuffer & frameBuffer) {
+            return denoise(frameBuffer, frameBuffer.color);
+        }
+
+        /*
+         * 降噪并将结果写入output（与color布局相同），帧缓冲区保持不变
+         * 渐进式渲染的预览降噪使用此函数：自适应采样跳过的像素不会重新计算color，降噪结果不能写回帧缓冲区
+         * 降噪失败时output保持不变并返回false，调用者不能使用output
+         */
+        bool denoise(const FrameBuffer & frameBuffer, std::vector<float> & output) {
+            if (frameBuffer.width != windowWidth || frameBuffer.height != windowHeight) {
+                throw std::runtime_error("Frame buffer size does not match denoiser");
+            }
             SDL_Log("Denoising...");
+
+            //帧缓冲区由渲染函数持有，降噪前拷贝到设备可访问的缓冲区
+            const size_t bufferSize = frameBuffer.pixelCount() * 3 * sizeof(float);
+            memcpy(colorPtr, frameBuffer.color.data(), bufferSize);
+            memcpy(albedoPtr, frameBuffer.albedo.data(), bufferSize);
+            memcpy(normalPtr, frameBuffer.normal.data(), bufferSize);
+
             oidn::FilterRef filter = device.newFilter("RT");
 
             filter.setImage("color",  colorBuffer,  oidn::Format::Float3, windowWidth, windowHeight);
@@ -68,22 +87,13 @@ namespace renderer {
             const char * errorMessage;
             if (device.getError(errorMessage) != oidn::Error::None) {
                 SDL_Log("OIDN Error: %s, stop denoising", errorMessage);
-                return;
+                return false;
             }
 
-            //写入颜色
-            const auto * denoisedColorPtr = static_cast<const float*>(colorBuffer.getData());
-
-            for (int i = 0; i < windowHeight; i++) {
-                for (int j = 0; j < windowWidth; j++) {
-                    const size_t pixel_idx = (i * windowWidth + j) * 3;
-                    Color3 color;
-                    for (int k = 0; k < 3; k++) {
-                        color[k] = denoisedColorPtr[pixel_idx + k];
-                    }
-                    color.writeColor(pixels + (i * windowWidth + j), format);
-                }
-            }
+            //写出颜色
+            output.resize(frameBuffer.pixelCount() * 3);
+            memcpy(output.data(), colorPtr, bufferSize);
+            return true;
         }
     };
 }
@@ -0,0 +1,213 @@
+#ifndef RENDERERBUILD_FRAMEBUFFER_HPP
+#define RENDERERBUILD_FRAMEBUFFER_HPP
+
+#include <basic/Color3.hpp>
+#include <basic/Vec3.hpp>
+#include <util/TraversalStatistics.hpp>
+
+namespace renderer {
+    /*
+     * 一条光路的渲染结果：颜色以及降噪器使用的第一个碰撞点的反照率和法向量（AOV）
+     * 由渲染函数按值返回，每个采样独立，不需要共享的临时缓冲区
+     */
+    struct PathSample {
+        Color3 color;
+        Color3 albedo;
+        Vec3 normal;
+        Uint32 rayCount = 0; //光路发射的光线数，包括相机光线和阴影光线，用于统计光线吞吐量
+    };
+
+    /*
+     * 一个像素在一轮渲染中的采样结果之和
+     * 同时使用Welford算法统计采样亮度的均值和偏差平方和，用于自适应采样估计像素的误差
+     */
+    struct PixelSampleSum {
+        Color3 color;
+        Color3 albedo;
+        Vec3 normal;
+        Uint32 sampleCount = 0;
+        double luminanceMean = 0.0;
+        double luminanceM2 = 0.0;
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+        TraversalCounters traversal {}; //本轮采样的遍历统计
+#endif
+
+        void addSample(const PathSample & sample) {
+            color += sample.color;
+            albedo += sample.albedo;
+            normal += sample.normal;
+
+            sampleCount++;
+            const double luminance = sample.color.luminance();
+            const double delta = luminance - luminanceMean;
+            luminanceMean += delta / sampleCount;
+            luminanceM2 += delta * (luminance - luminanceMean);
+        }
+    };
+
+    /*
+     * 浮点帧缓冲区
+     * 保存线性HDR颜色以及降噪器使用的反照率和法向量，每个像素3个float分量，按行优先存储
+     * 渲染函数只写入此缓冲区，不依赖窗口，显示和保存文件时再转换为8位颜色
+     *
+     * 采样结果先累加到累加缓冲区，color、albedo和normal为累加结果的平均值
+     * 渐进式渲染时每一轮的采样继续累加，累加缓冲区在多轮之间保持不变
+     */
+    class FrameBuffer {
+    public:
+        Uint32 width, height;
+
+        std::vector<float> color;  //线性颜色
+        std::vector<float> albedo; //辅助信息：衰减颜色
+        std::vector<float> normal; //辅助信息：表面法线
+
+        //累加缓冲区：采样结果之和以及每个像素的累计采样数
+        std::vector<float> colorSum;
+        std::vector<float> albedoSum;
+        std::vector<float> normalSum;
+        std::vector<Uint32> sampleCounts;
+
+        //每个像素全部采样的亮度均值和偏差平方和
+        std::vector<float> luminanceMean;
+        std::vector<float> luminanceM2;
+
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+        /*
+         * 遍历统计热力图AOV，每个像素HEATMAP_CHANNEL_COUNT个分量，依次为每条光路平均访问的BVH节点数、图元相交测试数、线段数和阴影光线数
+         * traversalSum为累计值，traversalHeatmap为累计值除以采样数，自适应采样时各像素的值仍可比较
+         */
+        static constexpr size_t HEATMAP_CHANNEL_COUNT = 4;
+        std::vector<Uint64> traversalSum;
+        std::vector<float> traversalHeatmap;
+#endif
+
+        FrameBuffer(Uint32 width, Uint32 height) :
+                width(width), height(height),
+                color(pixelCount() * 3, 0.0f), albedo(pixelCount() * 3, 0.0f), normal(pixelCount() * 3, 0.0f),
+                colorSum(pixelCount() * 3, 0.0f), albedoSum(pixelCount() * 3, 0.0f), normalSum(pixelCount() * 3, 0.0f),
+                sampleCounts(pixelCount(), 0), luminanceMean(pixelCount(), 0.0f), luminanceM2(pixelCount(), 0.0f)
+        {
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+            traversalSum.assign(pixelCount() * HEATMAP_CHANNEL_COUNT, 0);
+            traversalHeatmap.assign(pixelCount() * HEATMAP_CHANNEL_COUNT, 0.0f);
+#endif
+        }
+
+        // ====== 对象操作函数 ======
+
+        size_t pixelCount() const {
+            return static_cast<size_t>(width) * height;
+        }
+
+        //像素(row, col)在分量数组中的起始下标
+        size_t pixelIndex(Uint32 row, Uint32 col) const {
+            return (static_cast<size_t>(row) * width + col) * 3;
+        }
+
+        //清空累加缓冲区，重新开始累加
+        void clearAccumulation() {
+            std::fill(colorSum.begin(), colorSum.end(), 0.0f);
+            std::fill(albedoSum.begin(), albedoSum.end(), 0.0f);
+            std::fill(normalSum.begin(), normalSum.end(), 0.0f);
+            std::fill(sampleCounts.begin(), sampleCounts.end(), 0);
+            std::fill(luminanceMean.begin(), luminanceMean.end(), 0.0f);
+            std::fill(luminanceM2.begin(), luminanceM2.end(), 0.0f);
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+            std::fill(traversalSum.begin(), traversalSum.end(), 0);
+            std::fill(traversalHeatmap.begin(), traversalHeatmap.end(), 0.0f);
+#endif
+        }
+
+        /*
+         * 将一个像素新增的采样之和累加到累加缓冲区，并更新该像素的平均值
+         * 亮度统计量按Chan的并行合并公式与已有采样合并
+         * 法向量取累加结果的方向，所有采样都没有击中物体时法向量为0，保持为0，避免向降噪器和法向量图层写入NaN
+         */
+        void accumulatePixel(Uint32 row, Uint32 col, const PixelSampleSum & samples) {
+            if (samples.sampleCount == 0) {
+                return;
+            }
+            const size_t index = pixelIndex(row, col);
+            Uint32 & count = sampleCounts[index / 3];
+            const Uint32 previousCount = count;
+            count += samples.sampleCount;
+            const float reciprocalCount = 1.0f / static_cast<float>(count);
+
+            const double delta = samples.luminanceMean - luminanceMean[index / 3];
+            luminanceMean[index / 3] += static_cast<float>(delta * samples.sampleCount / count);
+            luminanceM2[index / 3] += static_cast<float>(samples.luminanceM2 + delta * delta * previousCount * samples.sampleCount / count);
+
+            float normalLengthSquare = 0.0f;
+            for (int k = 0; k < 3; k++) {
+                colorSum[index + k] += static_cast<float>(samples.color[k]);
+                albedoSum[index + k] += static_cast<float>(samples.albedo[k]);
+                normalSum[index + k] += static_cast<float>(samples.normal[k]);
+                color[index + k] = colorSum[index + k] * reciprocalCount;
+                albedo[index + k] = albedoSum[index + k] * reciprocalCount;
+                normalLengthSquare += normalSum[index + k] * normalSum[index + k];
+            }
+            const float reciprocalNormalLength = normalLengthSquare > 0.0f ? 1.0f / std::sqrt(normalLengthSquare) : 0.0f;
+            for (int k = 0; k < 3; k++) {
+                normal[index + k] = normalSum[index + k] * reciprocalNormalLength;
+            }
+
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+            const size_t heatmapIndex = index / 3 * HEATMAP_CHANNEL_COUNT;
+            const Uint64 traversalValues[HEATMAP_CHANNEL_COUNT] = {
+                    samples.traversal.nodeCount, samples.traversal.primitiveTestCount(),
+                    samples.traversal.bounceCount, samples.traversal.shadowRayCount
+            };
+            for (size_t k = 0; k < HEATMAP_CHANNEL_COUNT; k++) {
+                traversalSum[heatmapIndex + k] += traversalValues[k];
+                traversalHeatmap[heatmapIndex + k] = static_cast<float>(traversalSum[heatmapIndex + k]) * reciprocalCount;
+            }
+#endif
+        }
+
+        /*
+         * 像素均值的误差，换算到writeColor显示时的伽马校正（gamma = 2.0）和裁剪之后
+         * 取均值加减一个标准误差的区间，映射为显示值sqrt(clamp(x, 0, 1))后区间宽度的一半
+         * 暗部像素的相同误差在显示时更明显，而超出显示范围的过亮像素（焦散、光源）的误差不可见
+         * 采样数少于2时无法估计方差，返回无穷大
+         */
+        double displayError(Uint32 row, Uint32 col) const {
+            const size_t index = static_cast<size_t>(row) * width + col;
+            const Uint32 count = sampleCounts[index];
+            if (count < 2) {
+                return INFINITY;
+            }
+            const double standardError = std::sqrt(luminanceM2[index] / (count - 1) / count);
+            const Range intensity(0.0, 1.0);
+            const double upper = std::sqrt(intensity.clamp(luminanceMean[index] + standardError));
+            const double lower = std::sqrt(intensity.clamp(luminanceMean[index] - standardError));
+            return 0.5 * (upper - lower);
+        }
+
+        /*
+         * 将矩形区域[rowStart, rowEnd) x [colStart, colEnd)的颜色经过伽马校正后写入8位像素数组
+         * pixels的尺寸必须与帧缓冲区相同
+         */
+        void writePixels(Uint32 * pixels, const SDL_PixelFormat * format,
+                         Uint32 rowStart, Uint32 rowEnd, Uint32 colStart, Uint32 colEnd) const {
+            writePixels(color.data(), pixels, format, rowStart, rowEnd, colStart, colEnd);
+        }
+
+        void writePixels(Uint32 * pixels, const SDL_PixelFormat * format) const {
+            writePixels(color.data(), pixels, format, 0, height, 0, width);
+        }
+
+        //将与color布局相同的外部颜色数组（如预览降噪结果）写入像素数组
+        void writePixels(const float * source, Uint32 * pixels, const SDL_PixelFormat * format,
+                         Uint32 rowStart, Uint32 rowEnd, Uint32 colStart, Uint32 colEnd) const {
+            for (Uint32 i = rowStart; i < rowEnd; i++) {
+                for (Uint32 j = colStart; j < colEnd; j++) {
+                    const size_t index = pixelIndex(i, j);
+                    const Color3 pixelColor(source[index], source[index + 1], source[index + 2]);
+                    pixelColor.writeColor(pixels + (static_cast<size_t>(i) * width + j), format);
+                }
+            }
+        }
+    };
+}
+
+#endif //RENDERERBUILD_FRAMEBUFFER_HPP
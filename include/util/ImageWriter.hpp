@@ -0,0 +1,32 @@
+#ifndef RENDERERBUILD_IMAGEWRITER_HPP
+#define RENDERERBUILD_IMAGEWRITER_HPP
+
+#include <util/FrameBuffer.hpp>
+
+namespace renderer {
+    /*
+     * 图像文件输出，由CPU执行
+     * 直接读取帧缓冲区，不需要窗口，无窗口渲染时同样可用
+     * PNG为伽马校正后的8位颜色，PFM和EXR保存线性浮点数据，逐行从帧缓冲区写入文件
+     */
+    class ImageWriter {
+    public:
+        //根据扩展名（.png、.pfm、.exr，不区分大小写）选择输出格式
+        static void save(const FrameBuffer & frameBuffer, const std::string & path);
+
+        //伽马校正并量化为8位颜色后保存为PNG
+        static void savePNG(const FrameBuffer & frameBuffer, const std::string & path);
+
+        //保存线性颜色为PFM（Portable Float Map），三通道32位浮点
+        static void savePFM(const FrameBuffer & frameBuffer, const std::string & path);
+
+        /*
+         * 保存为无压缩的单部分扫描线OpenEXR，32位浮点通道：
+         * 颜色为R、G、B，降噪辅助信息作为图层albedo.R/G/B和normal.X/Y/Z
+         * 启用遍历统计时追加热力图图层traversal.nodes/primitives/bounces/shadowRays
+         */
+        static void saveEXR(const FrameBuffer & frameBuffer, const std::string & path);
+    };
+}
+
+#endif //RENDERERBUILD_IMAGEWRITER_HPP
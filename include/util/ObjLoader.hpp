@@ -0,0 +1,78 @@
+#ifndef RENDERERBUILD_OBJLOADER_HPP
+#define RENDERERBUILD_OBJLOADER_HPP
+
+#include <box/BVHTree.hpp>
+#include <material/Rough.hpp>
+#include <material/DiffuseLight.hpp>
+
+namespace renderer {
+    //OBJ加载参数
+    struct ObjLoadOptions {
+        //加载得到的材质在最终材质数组中的起始下标，将模型材质追加在场景已有材质之后时使用
+        Uint32 roughMaterialOffset;
+        Uint32 lightMaterialOffset;
+
+        //网格内部BVH的构建参数
+        BVHBuildOptions bvhOptions;
+
+        explicit ObjLoadOptions(Uint32 roughMaterialOffset = 0, Uint32 lightMaterialOffset = 0,
+                                const BVHBuildOptions & bvhOptions = BVHBuildOptions()) :
+                roughMaterialOffset(roughMaterialOffset), lightMaterialOffset(lightMaterialOffset), bvhOptions(bvhOptions) {}
+    };
+
+    /*
+     * OBJ模型：按usemtl分组，每组生成一个TriangleMesh
+     * 网格引用本对象持有的顶点和索引数组，因此对象不可拷贝，只能移动（移动vector不会改变其元素地址）
+     */
+    class ObjModel {
+    public:
+        //一个材质分组的顶点数据，OBJ中位置、纹理坐标和法向量下标组合相同的顶点只存储一次
+        struct MeshData {
+            std::string materialName;
+            std::vector<float> positions;
+            std::vector<float> normals; //分组中有顶点缺少法向量时为空
+            std::vector<float> uvs;     //分组中有顶点缺少纹理坐标时为空
+            std::vector<Uint32> indices;
+        };
+
+        std::vector<MeshData> meshData;
+        std::vector<TriangleMesh> meshes;
+        std::vector<BVHTree::MeshBVH> meshBVHs;
+
+        //由mtllib中的材质生成：Ke不为0的材质为DiffuseLight，其他材质使用Kd作为Rough的颜色
+        std::vector<Rough> roughMaterials;
+        std::vector<DiffuseLight> lightMaterials;
+
+        ObjModel() = default;
+        ObjModel(const ObjModel & obj) = delete;
+        ObjModel & operator=(const ObjModel & obj) = delete;
+        ObjModel(ObjModel && obj) = default;
+        ObjModel & operator=(ObjModel && obj) = default;
+
+        size_t triangleCount() const {
+            size_t ret = 0;
+            for (const auto & data : meshData) {
+                ret += data.indices.size() / 3;
+            }
+            return ret;
+        }
+    };
+
+    /*
+     * Wavefront OBJ加载器，由CPU执行
+     * 支持v、vt、vn、f（三角形和多边形，多边形按扇形三角化）、usemtl和mtllib（newmtl、Kd、Ke）
+     * 文件按块读入固定大小的缓冲区逐行解析，不整体读入内存，数字解析不使用iostream
+     */
+    class ObjLoader {
+    public:
+        static ObjModel load(const std::string & path, const ObjLoadOptions & options = ObjLoadOptions());
+
+        //解析一个浮点数，成功时移动p到数字之后
+        static bool parseDouble(const char * & p, const char * end, double & value);
+
+        //解析一个有符号整数，成功时移动p到数字之后
+        static bool parseInteger(const char * & p, const char * end, long long & value);
+    };
+}
+
+#endif //RENDERERBUILD_OBJLOADER_HPP
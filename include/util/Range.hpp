@@ -9,11 +9,11 @@ namespace renderer {
      */
     class Range {
     public:
-        double min;
-        double max;
+        Real min;
+        Real max;
 
         //默认构造空区间
-        explicit Range(double min = 0.0, double max = 0.0) : min(min), max(max) {}
+        explicit Range(Real min = 0.0, Real max = 0.0) : min(min), max(max) {}
 
         //构造两个区间的并集
         Range(const Range & r1, const Range & r2) :
@@ -21,7 +21,7 @@ namespace renderer {
 
         // ====== 对象操作函数 ======
 
-        bool inRange(double value, bool isLeftClose = true, bool isRightClose = true) const {
+        bool inRange(Real value, bool isLeftClose = true, bool isRightClose = true) const {
             const bool equalsToMin = floatValueEquals(value, min);
             const bool equalsToMax = floatValueEquals(value, max);
 
@@ -31,7 +31,15 @@ namespace renderer {
             return true;
         }
 
-        Range & offset(double offsetValue) {
+        /*
+         * 判断value是否严格位于区间内部，不使用inRange的绝对误差容限
+         * 用于光线参数t的检测：光线起点已经偏移离开表面，t的下限为0，容限会使起点后方的交点被接受
+         */
+        bool surrounds(Real value) const {
+            return min < value && value < max;
+        }
+
+        Range & offset(Real offsetValue) {
             min += offsetValue;
             max += offsetValue;
             return *this;
@@ -41,11 +49,11 @@ namespace renderer {
             return min < max || floatValueEquals(min, max);
         }
 
-        double length() const {
+        Real length() const {
             return max - min;
         }
 
-        double clamp(double value) const {
+        Real clamp(Real value) const {
             if (value > max) {
                 return max;
             } else if (value < min) {
@@ -56,7 +64,7 @@ namespace renderer {
         }
 
         //将当前区间左右端点各扩展length长度
-        Range & expand(double length) {
+        Range & expand(Real length) {
             if (length > 0) { //负长度不扩展
                 min -= length;
                 max += length;
@@ -0,0 +1,149 @@
+#ifndef RENDERERBUILD_SAMPLER_HPP
+#define RENDERERBUILD_SAMPLER_HPP
+
+#include <Global.hpp>
+
+namespace renderer {
+    //采样器类型枚举
+    enum class SamplerType {
+        INDEPENDENT, //独立随机数，每个维度直接使用PCG32
+        SOBOL        //Owen扰乱的Sobol序列
+    };
+
+    /*
+     * 采样器：为一个像素的每个采样按维度提供[0, 1)之间的采样值
+     * 渲染路径上的所有随机决策（像素位置、镜头、快门时间、光源选择、方向采样、俄罗斯轮盘赌等）都从采样器获取
+     *
+     * SOBOL模式下，每个一维或二维请求使用Sobol序列的前一个或两个维度，
+     * 采样下标先按维度的种子打乱顺序（Owen扰乱），采样值再按另一个种子进行Owen扰乱，不同维度之间互不相关（填充式Sobol）
+     * 对同一像素的前2^k个采样，每个维度（以及每个二维请求的两个维度）都是分层的，多轮渲染时继续使用后续的采样下标
+     * 维度由调用者按固定布局划分，每一段维度用完之后改用PCG32，避免不同用途的请求复用同一维度
+     *
+     * 只包含整数状态，可以按值拷贝并上传到GPU
+     */
+    class Sampler {
+    private:
+        SamplerType type;
+        Uint64 seed;            //像素的扰乱种子，同一像素的所有采样相同
+        RandomGenerator rng;    //INDEPENDENT模式以及超出维度段后使用
+        Uint32 reversedSampleIndex; //位序翻转后的采样下标，每个采样只计算一次
+        Uint32 dimension;
+        Uint32 dimensionEnd;
+
+        static Uint32 reverseBits(Uint32 value) {
+            value = (value << 16u) | (value >> 16u);
+            value = ((value & 0x00ff00ffu) << 8u) | ((value & 0xff00ff00u) >> 8u);
+            value = ((value & 0x0f0f0f0fu) << 4u) | ((value & 0xf0f0f0f0u) >> 4u);
+            value = ((value & 0x33333333u) << 2u) | ((value & 0xccccccccu) >> 2u);
+            value = ((value & 0x55555555u) << 1u) | ((value & 0xaaaaaaaau) >> 1u);
+            return value;
+        }
+
+        /*
+         * Laine-Karras置换：低位的值只影响高位
+         * 对位序翻转后的值进行置换，即为Owen扰乱（嵌套均匀扰乱）：高位（更大的区间）的值只影响低位（区间内的位置）
+         */
+        static Uint32 laineKarrasPermutation(Uint32 value, Uint32 scrambleSeed) {
+            value += scrambleSeed;
+            value ^= value * 0x6c50b47cu;
+            value ^= value * 0xb82f1e52u;
+            value ^= value * 0xc7afe638u;
+            value ^= value * 0x8d22f6e6u;
+            return value;
+        }
+
+        //Sobol序列的第二个维度，第一个维度为位序翻转（van der Corput序列）
+        static Uint32 sobolSecondDimension(Uint32 index) {
+            Uint32 result = 0;
+            for (Uint32 v = 1u << 31u; index != 0; index >>= 1u, v ^= v >> 1u) {
+                if (index & 1u) {
+                    result ^= v;
+                }
+            }
+            return result;
+        }
+
+        //当前维度的扰乱种子，低32位用于打乱采样下标，高32位用于扰乱采样值
+        Uint64 dimensionSeed() const {
+            return mixBits(seed ^ (static_cast<Uint64>(dimension) * 0x9e3779b97f4a7c15ULL));
+        }
+
+        /*
+         * 按当前维度的种子打乱采样下标，返回位序翻转的打乱结果，即Sobol序列第一个维度的值
+         * 打乱后的下标本身为其位序翻转
+         */
+        Uint32 shuffledFirstDimension(Uint32 indexSeed) const {
+            return laineKarrasPermutation(reversedSampleIndex, indexSeed);
+        }
+
+        //对Sobol序列的值进行Owen扰乱，转换为[0, 1)之间的浮点数
+        static double scrambleToUnitDouble(Uint32 value, Uint32 scrambleSeed) {
+            return reverseBits(laineKarrasPermutation(reverseBits(value), scrambleSeed)) * (1.0 / 4294967296.0);
+        }
+
+        bool isSobolDimension(Uint32 count) const {
+            return type == SamplerType::SOBOL && dimension + count <= dimensionEnd;
+        }
+
+    public:
+        Sampler(SamplerType type, Uint64 seed, const RandomGenerator & rng) :
+                type(type), seed(seed), rng(rng), reversedSampleIndex(0), dimension(0), dimensionEnd(0) {}
+
+        // ====== 对象操作函数 ======
+
+        //开始像素的第index个采样，index为该像素所有轮次中的累计下标
+        void startSample(Uint32 index) {
+            reversedSampleIndex = reverseBits(index);
+            dimension = 0;
+            dimensionEnd = 0;
+        }
+
+        //从第first个维度开始使用长度为count的维度段，超出维度段的请求使用PCG32
+        void startDimensions(Uint32 first, Uint32 count) {
+            dimension = first;
+            dimensionEnd = first + count;
+        }
+
+        //生成一个[0, 1)之间的采样值，占用一个维度
+        double nextDouble() {
+            if (!isSobolDimension(1)) {
+                return rng.nextDouble();
+            }
+            const Uint64 dimensionHash = dimensionSeed();
+            const Uint32 value = shuffledFirstDimension(static_cast<Uint32>(dimensionHash));
+            dimension++;
+            return scrambleToUnitDouble(value, static_cast<Uint32>(dimensionHash >> 32u));
+        }
+
+        //生成一个[min, max)之间的采样值
+        double nextDouble(double min, double max) {
+            return min + (max - min) * nextDouble();
+        }
+
+        //生成一个[min, max]之间的整数
+        int nextInt(int min, int max) {
+            if (!isSobolDimension(1)) {
+                return rng.nextInt(min, max);
+            }
+            const int ret = min + static_cast<int>(nextDouble() * (max - min + 1));
+            return std::min(ret, max);
+        }
+
+        //生成一个二维采样值，两个分量在[0, 1)之间且联合分层，占用两个维度
+        void next2D(double & u, double & v) {
+            if (!isSobolDimension(2)) {
+                u = rng.nextDouble();
+                v = rng.nextDouble();
+                return;
+            }
+            const Uint64 dimensionHash = dimensionSeed();
+            const Uint32 value = shuffledFirstDimension(static_cast<Uint32>(dimensionHash));
+            const Uint32 secondSeed = static_cast<Uint32>(mixBits(dimensionHash));
+            u = scrambleToUnitDouble(value, static_cast<Uint32>(dimensionHash >> 32u));
+            v = scrambleToUnitDouble(sobolSecondDimension(reverseBits(value)), secondSeed);
+            dimension += 2;
+        }
+    };
+}
+
+#endif //RENDERERBUILD_SAMPLER_HPP
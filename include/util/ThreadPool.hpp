@@ -0,0 +1,247 @@
+#ifndef RENDERERBUILD_THREADPOOL_HPP
+#define RENDERERBUILD_THREADPOOL_HPP
+
+#include <Global.hpp>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <chrono>
+
+namespace renderer {
+    /*
+     * 工作窃取线程池，由CPU执行
+     * 每个工作线程拥有独立的任务队列，线程优先从自己队列的头部取任务，自己的队列为空时从其他线程队列的尾部窃取任务
+     * 任务函数的参数为执行该任务的工作线程下标，任务可以通过此下标访问线程私有的缓冲区
+     */
+    class ThreadPool {
+    public:
+        typedef std::function<void(size_t)> Task;
+
+        //并行循环的分块函数，参数为块下标、块的起始下标和结束下标（不含）
+        typedef std::function<void(size_t, size_t, size_t)> ChunkFunction;
+
+    private:
+        //单个工作线程的任务队列
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        size_t threadCount;
+        std::vector<std::thread> threads;
+        std::unique_ptr<WorkerQueue[]> queues; //mutex不可移动，不能放入vector
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;  //有新任务时唤醒空闲线程
+        std::condition_variable finishCondition; //所有任务完成时唤醒等待线程
+
+        std::atomic<size_t> queuedCount;  //队列中等待执行的任务数
+        std::atomic<size_t> pendingCount; //已提交但未执行完成的任务数
+        std::atomic<size_t> nextQueue;    //外部线程提交任务时轮流选择队列
+        bool isStopping;
+
+        //当前线程所属的线程池和工作线程下标，非工作线程的pool为nullptr
+        struct WorkerInfo {
+            const ThreadPool * pool;
+            size_t index;
+        };
+
+        static WorkerInfo & currentWorker() {
+            static thread_local WorkerInfo info {nullptr, 0};
+            return info;
+        }
+
+        //一次并行循环的共享状态，由调用线程和辅助任务共同持有，辅助任务晚于循环结束执行时也能安全访问
+        struct ParallelForState {
+            ChunkFunction function;
+            size_t count;
+            size_t grainSize;
+            size_t chunkCount;
+
+            std::atomic<size_t> nextChunk;
+            std::atomic<size_t> finishedChunkCount;
+            std::mutex mutex;
+            std::condition_variable finishCondition;
+
+            ParallelForState(const ChunkFunction & function, size_t count, size_t grainSize, size_t chunkCount) :
+                    function(function), count(count), grainSize(grainSize), chunkCount(chunkCount),
+                    nextChunk(0), finishedChunkCount(0) {}
+        };
+
+        //领取并执行尚未执行的块，直到所有块都被领取
+        static void runChunks(ParallelForState & state) {
+            size_t chunk;
+            while ((chunk = state.nextChunk++) < state.chunkCount) {
+                const size_t begin = chunk * state.grainSize;
+                state.function(chunk, begin, std::min(begin + state.grainSize, state.count));
+                if (++state.finishedChunkCount == state.chunkCount) {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    state.finishCondition.notify_all();
+                }
+            }
+        }
+
+        //取出一个任务：先取自己队列头部的任务，再从其他队列尾部窃取
+        bool popTask(size_t workerIndex, Task & task) {
+            {
+                WorkerQueue & own = queues[workerIndex];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.tasks.empty()) {
+                    task = std::move(own.tasks.front());
+                    own.tasks.pop_front();
+                    queuedCount--;
+                    return true;
+                }
+            }
+            for (size_t i = 1; i < threadCount; i++) {
+                WorkerQueue & victim = queues[(workerIndex + i) % threadCount];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    task = std::move(victim.tasks.back());
+                    victim.tasks.pop_back();
+                    queuedCount--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void workerLoop(size_t workerIndex) {
+            currentWorker() = {this, workerIndex};
+
+            while (true) {
+                Task task;
+                if (popTask(workerIndex, task)) {
+                    task(workerIndex);
+                    if (--pendingCount == 0) {
+                        //在锁内通知，避免等待线程检查条件后、进入等待前丢失通知
+                        std::lock_guard<std::mutex> lock(sleepMutex);
+                        finishCondition.notify_all();
+                    }
+                    continue;
+                }
+
+                //没有可执行的任务，进入休眠直到有新任务提交
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleepCondition.wait(lock, [this] { return isStopping || queuedCount > 0; });
+                if (isStopping) {
+                    return;
+                }
+            }
+        }
+
+    public:
+        //threadCount为0时使用硬件线程数
+        explicit ThreadPool(size_t threadCount = 0) :
+                threadCount(threadCount > 0 ? threadCount : hardwareThreadCount()),
+                queuedCount(0), pendingCount(0), nextQueue(0), isStopping(false)
+        {
+            queues.reset(new WorkerQueue[this->threadCount]);
+            threads.reserve(this->threadCount);
+            for (size_t i = 0; i < this->threadCount; i++) {
+                threads.emplace_back(&ThreadPool::workerLoop, this, i);
+            }
+        }
+
+        ThreadPool(const ThreadPool & obj) = delete;
+        ThreadPool & operator=(const ThreadPool & obj) = delete;
+
+        //等待所有任务完成后停止工作线程
+        ~ThreadPool() {
+            wait();
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                isStopping = true;
+            }
+            sleepCondition.notify_all();
+            for (auto & thread : threads) {
+                thread.join();
+            }
+        }
+
+        // ====== 对象操作函数 ======
+
+        size_t size() const {
+            return threadCount;
+        }
+
+        /*
+         * 提交任务
+         * 在工作线程中提交的任务放入该线程自己的队列（任务派生子任务），在外部线程中提交的任务轮流放入各个队列
+         */
+        void submit(Task task) {
+            const WorkerInfo & info = currentWorker();
+            const size_t queueIndex = info.pool == this ? info.index : nextQueue++ % threadCount;
+
+            pendingCount++;
+            {
+                WorkerQueue & queue = queues[queueIndex];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                queuedCount++;
+            }
+            sleepCondition.notify_one();
+        }
+
+        //阻塞等待所有已提交的任务完成，不能在工作线程中调用
+        void wait() {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            finishCondition.wait(lock, [this] { return pendingCount == 0; });
+        }
+
+        //最多等待milliseconds毫秒，所有任务完成时返回true
+        bool waitFor(Uint32 milliseconds) {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            return finishCondition.wait_for(lock, std::chrono::milliseconds(milliseconds),
+                                            [this] { return pendingCount == 0; });
+        }
+
+        /*
+         * 并行循环：将[0, count)按grainSize划分为若干块，由调用线程和线程池共同执行，所有块完成后返回
+         * 块由执行线程动态领取，调用线程不会因为队列中排在前面的其他任务而空等
+         * 只等待本次循环的块，不等待其他已提交的任务；在工作线程中调用时直接在当前线程顺序执行，避免工作线程互相等待
+         */
+        void parallelFor(size_t count, size_t grainSize, const ChunkFunction & function) {
+            grainSize = std::max<size_t>(grainSize, 1);
+            const size_t chunks = chunkCount(count, grainSize);
+            if (chunks <= 1 || currentWorker().pool == this) {
+                for (size_t chunk = 0; chunk < chunks; chunk++) {
+                    const size_t begin = chunk * grainSize;
+                    function(chunk, begin, std::min(begin + grainSize, count));
+                }
+                return;
+            }
+
+            auto state = std::make_shared<ParallelForState>(function, count, grainSize, chunks);
+            const size_t helperCount = std::min(threadCount, chunks - 1);
+            for (size_t i = 0; i < helperCount; i++) {
+                submit([state](size_t) { runChunks(*state); });
+            }
+            runChunks(*state);
+
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->finishCondition.wait(lock, [&state] { return state->finishedChunkCount == state->chunkCount; });
+        }
+
+        // ====== 静态操作函数 ======
+
+        //并行循环划分出的块数
+        static size_t chunkCount(size_t count, size_t grainSize) {
+            return (count + grainSize - 1) / grainSize;
+        }
+
+        static size_t hardwareThreadCount() {
+            const unsigned int count = std::thread::hardware_concurrency();
+            return count > 0 ? count : 1; //无法获取时返回1
+        }
+    };
+}
+
+#endif //RENDERERBUILD_THREADPOOL_HPP
@@ -0,0 +1,76 @@
+#ifndef RENDERERBUILD_TRAVERSALSTATISTICS_HPP
+#define RENDERERBUILD_TRAVERSALSTATISTICS_HPP
+
+#include <basic/Structs.hpp>
+
+namespace renderer {
+    /*
+     * 遍历统计计数器：BVH节点访问数、按图元类型统计的相交测试数、光路线段数和阴影光线数
+     * 没有构造函数，使用TraversalCounters counters {}进行零初始化
+     */
+    struct TraversalCounters {
+        static constexpr size_t PRIMITIVE_TYPE_COUNT = 6;
+
+        Uint64 nodeCount;                                 //访问的BVH中间节点数，包括网格内部BVH
+        Uint64 primitiveTestCounts[PRIMITIVE_TYPE_COUNT]; //场景BVH叶子中的图元相交测试数，下标为PrimitiveType
+        Uint64 meshTriangleTestCount;                     //网格内部BVH叶子中的三角形相交测试数
+        Uint64 pathCount;                                 //相机光路数
+        Uint64 bounceCount;                               //光路追踪的线段数
+        Uint64 shadowRayCount;                            //光源采样发射的阴影光线数
+
+        //所有图元和网格三角形的相交测试数
+        Uint64 primitiveTestCount() const {
+            Uint64 ret = meshTriangleTestCount;
+            for (size_t i = 0; i < PRIMITIVE_TYPE_COUNT; i++) {
+                ret += primitiveTestCounts[i];
+            }
+            return ret;
+        }
+
+        TraversalCounters & operator+=(const TraversalCounters & obj) {
+            nodeCount += obj.nodeCount;
+            for (size_t i = 0; i < PRIMITIVE_TYPE_COUNT; i++) {
+                primitiveTestCounts[i] += obj.primitiveTestCounts[i];
+            }
+            meshTriangleTestCount += obj.meshTriangleTestCount;
+            pathCount += obj.pathCount;
+            bounceCount += obj.bounceCount;
+            shadowRayCount += obj.shadowRayCount;
+            return *this;
+        }
+
+        TraversalCounters operator-(const TraversalCounters & obj) const {
+            TraversalCounters ret = *this;
+            ret.nodeCount -= obj.nodeCount;
+            for (size_t i = 0; i < PRIMITIVE_TYPE_COUNT; i++) {
+                ret.primitiveTestCounts[i] -= obj.primitiveTestCounts[i];
+            }
+            ret.meshTriangleTestCount -= obj.meshTriangleTestCount;
+            ret.pathCount -= obj.pathCount;
+            ret.bounceCount -= obj.bounceCount;
+            ret.shadowRayCount -= obj.shadowRayCount;
+            return ret;
+        }
+    };
+
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+    /*
+     * 当前线程的遍历统计计数器，只在定义RENDERER_TRAVERSAL_STATISTICS时存在（CMake选项RENDERER_ENABLE_TRAVERSAL_STATISTICS）
+     * 计数器只增不减，渲染函数在像素开始和结束时各读取一次，差值即为该像素的统计
+     * 线程局部变量只适用于CPU渲染，移植到GPU时改为每个线程的局部计数器
+     */
+    inline TraversalCounters & threadTraversalCounters() {
+        static thread_local TraversalCounters counters; //平凡类型的线程局部变量零初始化，访问时没有初始化检查
+        return counters;
+    }
+
+#define traversalStatisticsAdd(field, value) (renderer::threadTraversalCounters().field += (value))
+#define traversalStatisticsAddPrimitive(type) (renderer::threadTraversalCounters().primitiveTestCounts[static_cast<size_t>(type)]++)
+#else
+    //未启用遍历统计时计数宏展开为空语句，不产生任何开销
+#define traversalStatisticsAdd(field, value) ((void)0)
+#define traversalStatisticsAddPrimitive(type) ((void)0)
+#endif
+}
+
+#endif //RENDERERBUILD_TRAVERSALSTATISTICS_HPP
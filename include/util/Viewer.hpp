@@ -0,0 +1,73 @@
+#ifndef RENDERERBUILD_VIEWER_HPP
+#define RENDERERBUILD_VIEWER_HPP
+
+#include <util/FrameBuffer.hpp>
+
+namespace renderer {
+    /*
+     * SDL预览窗口，由CPU执行
+     * 渲染结果保存在FrameBuffer中，窗口只负责显示，无窗口（批处理）渲染时不创建此对象
+     * 所有函数只能在创建窗口的线程（主线程）中调用
+     */
+    class Viewer {
+    private:
+        SDL_Window * window;
+        SDL_Surface * surface; //窗口表面由SDL管理，随窗口一起释放
+
+    public:
+        Viewer(Uint32 width, Uint32 height, const char * title) : window(nullptr), surface(nullptr) {
+            window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                      static_cast<int>(width), static_cast<int>(height), SDL_WINDOW_SHOWN);
+            sdlCheckErrorPtr(window, "Create Window", EXIT_PROGRAM);
+            surface = SDL_GetWindowSurface(window);
+            sdlCheckErrorPtr(surface, "Get Surface", EXIT_PROGRAM);
+            SDL_Log("SDL Color Format: %s", SDL_GetPixelFormatName(surface->format->format));
+        }
+
+        ~Viewer() {
+            if (window != nullptr) {
+                releaseSDLResource(SDL_DestroyWindow(window), "Destroy Window");
+            }
+        }
+
+        Viewer(const Viewer & obj) = delete;
+        Viewer & operator=(const Viewer & obj) = delete;
+
+        // ====== 对象操作函数 ======
+
+        //处理窗口事件，用户关闭窗口时返回false
+        bool pollEvents() {
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                if (event.type == SDL_QUIT) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //将帧缓冲区的矩形区域写入窗口表面，调用update后显示
+        void writeRegion(const FrameBuffer & frameBuffer, Uint32 rowStart, Uint32 rowEnd, Uint32 colStart, Uint32 colEnd) {
+            frameBuffer.writePixels(static_cast<Uint32 *>(surface->pixels), surface->format, rowStart, rowEnd, colStart, colEnd);
+        }
+
+        void writeFrame(const FrameBuffer & frameBuffer) {
+            frameBuffer.writePixels(static_cast<Uint32 *>(surface->pixels), surface->format);
+        }
+
+        //显示与帧缓冲区布局相同的外部颜色数组，用于预览降噪结果
+        void writeFrame(const FrameBuffer & frameBuffer, const std::vector<float> & color) {
+            if (color.size() != frameBuffer.pixelCount() * 3) {
+                throw std::runtime_error("Preview color size does not match frame buffer!");
+            }
+            frameBuffer.writePixels(color.data(), static_cast<Uint32 *>(surface->pixels), surface->format,
+                                    0, frameBuffer.height, 0, frameBuffer.width);
+        }
+
+        void update() {
+            SDL_UpdateWindowSurface(window);
+        }
+    };
+}
+
+#endif //RENDERERBUILD_VIEWER_HPP
@@ -0,0 +1,528 @@
+#include <Render.hpp>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace renderer;
+
+/*
+ * 渲染基准测试程序
+ * 以固定的分辨率、种子和采样数渲染一组标准场景，输出JSON格式的性能统计，用于比较不同版本的渲染器
+ * 不创建窗口，不写入图像文件
+ *
+ * 命令行参数：[--scene 场景名]... [--threads N] [--spp N] [--output 文件路径] [--list]
+ *   --scene   只运行指定的场景，可以指定多个，默认运行所有场景
+ *   --threads 渲染线程数，默认为硬件线程数
+ *   --spp     覆盖所有场景的每像素采样数，用于快速检查，结果不能与默认采样数的结果比较
+ *   --output  JSON输出文件，默认输出到标准输出，日志输出到标准错误
+ */
+namespace {
+    constexpr Uint32 BENCHMARK_WIDTH = 400;
+    constexpr Uint32 BENCHMARK_HEIGHT = 225;
+    constexpr Uint64 BENCHMARK_SEED = 1;
+    constexpr Uint32 BENCHMARK_DEPTH = 10;
+
+    /*
+     * 基准测试场景，持有所有物体和材质数组
+     * Transform和TriangleMesh引用本对象中其他数组的元素，因此对象不可拷贝，只能移动（移动vector不会改变其元素地址）
+     */
+    struct BenchmarkScene {
+        std::string name;
+        Uint32 sampleCount = 16;
+
+        //相机参数
+        Color3 backgroundColor;
+        Point3 cameraCenter, cameraTarget;
+        double fov = 40.0;
+        double focusDiskRadius = 0.0;
+
+        std::vector<Rough> roughs;
+        std::vector<Metal> metals;
+        std::vector<DiffuseLight> lights;
+        std::vector<Dielectric> dielectrics;
+
+        std::vector<Sphere> spheres;
+        std::vector<Parallelogram> parallelograms;
+        std::vector<Box> boxes; //只通过transforms引用
+        std::vector<Transform> transforms;
+
+        //网格的顶点数据、网格对象和网格内部BVH
+        std::vector<float> meshPositions;
+        std::vector<Uint32> meshIndices;
+        std::vector<TriangleMesh> meshes;
+        std::vector<BVHTree::MeshBVH> meshBVHs;
+
+        //直接重要性采样物体
+        std::vector<Sphere> hittableSpheres;
+        std::vector<Parallelogram> hittableParallelograms;
+
+        BenchmarkScene() = default;
+        BenchmarkScene(const BenchmarkScene & obj) = delete;
+        BenchmarkScene & operator=(const BenchmarkScene & obj) = delete;
+        BenchmarkScene(BenchmarkScene && obj) = default;
+        BenchmarkScene & operator=(BenchmarkScene && obj) = default;
+
+        size_t primitiveCount() const {
+            size_t ret = spheres.size() + parallelograms.size() + transforms.size();
+            for (const auto & mesh : meshes) {
+                ret += mesh.getTriangleCount();
+            }
+            return ret;
+        }
+    };
+
+    //单个场景的测试结果
+    struct BenchmarkResult {
+        std::string name;
+        Uint32 sampleCount;
+        size_t primitiveCount;
+        RenderStatistics statistics;
+        Uint32 totalTime;
+        Uint64 peakMemoryKB;
+    };
+
+    struct CommandLineOptions {
+        std::vector<std::string> sceneNames;
+        Uint32 threadCount = 0;
+        Uint32 sampleCount = 0;
+        std::string outputPath;
+        bool isListOnly = false;
+    };
+
+    //进程启动以来的峰值常驻内存（KB），平台不支持时为0
+    Uint64 peakMemoryKB() {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return static_cast<Uint64>(counters.PeakWorkingSetSize) / 1024;
+        }
+        return 0;
+#elif defined(__unix__) || defined(__APPLE__)
+        rusage usage {};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#if defined(__APPLE__)
+        return static_cast<Uint64>(usage.ru_maxrss) / 1024; //macOS的单位为字节
+#else
+        return static_cast<Uint64>(usage.ru_maxrss);
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    // ====== 标准场景 ======
+
+    //Cornell盒：与主程序的默认场景相同，包含玻璃球、旋转的金属盒和面光源
+    BenchmarkScene cornellBoxScene() {
+        BenchmarkScene scene;
+        scene.name = "cornell";
+        scene.sampleCount = 64;
+        scene.cameraCenter = Point3(278, 278, -600);
+        scene.cameraTarget = Point3(278, 278, 0);
+        scene.fov = 80.0;
+
+        scene.roughs = {Rough(Color3(.65, .05, .05)), Rough(Color3(.73, .73, .73)), Rough(Color3(.12, .45, .15))};
+        scene.metals = {Metal(Color3(0.8, 0.85, 0.88), 0.0)};
+        scene.lights = {DiffuseLight(Color3(15.0, 15.0, 15.0))};
+        scene.dielectrics = {Dielectric(1.5)};
+
+        scene.spheres = {Sphere(0, MaterialType::DIELECTRIC, 0, Point3(190.0, 90.0, 190.0), 90.0)};
+        const Parallelogram light(5, MaterialType::DIFFUSE_LIGHT, 0, Point3(213.0, 554.0, 227.0), Vec3(130.0, 0.0, 0.0), Vec3(0.0, 0.0, 105.0));
+        scene.parallelograms = {
+                Parallelogram(0, MaterialType::ROUGH, 2, Point3(555.0, 0.0, 0.0), Vec3(0.0, 0.0, 555.0), Vec3(0.0, 555.0, 0.0)),
+                Parallelogram(1, MaterialType::ROUGH, 0, Point3(0.0, 0.0, 555.0), Vec3(0.0, 0.0, -555.0), Vec3(0.0, 555.0, 0.0)),
+                Parallelogram(2, MaterialType::ROUGH, 1, Point3(0.0, 555.0, 0.0), Vec3(555.0, 0.0, 0.0), Vec3(0.0, 0.0, 555.0)),
+                Parallelogram(3, MaterialType::ROUGH, 1, Point3(0.0, 0.0, 555.0), Vec3(555.0, 0.0, 0.0), Vec3(0.0, 0.0, -555.0)),
+                Parallelogram(4, MaterialType::ROUGH, 1, Point3(555.0, 0.0, 555.0), Vec3(-555.0, 0.0, 0.0), Vec3(0.0, 555.0, 0.0)),
+                light
+        };
+        scene.boxes = {Box(MaterialType::METAL, 0, Point3(), Point3(165.0, 330.0, 165.0))};
+        scene.transforms = {
+                Transform(scene.boxes.data(), PrimitiveType::BOX, 0, scene.boxes[0].constructBoundingBox(), scene.boxes[0].centroid(),
+                          std::array<double, 3>{0.0, 18.0, 0.0}, std::array<double, 3>{265.0, 0.0, 295.0})
+        };
+
+        scene.hittableSpheres = {scene.spheres[0]};
+        scene.hittableParallelograms = {light};
+        return scene;
+    }
+
+    //大量小球：地面上22 x 22个随机材质的小球和3个大球，天空光照明，带景深
+    BenchmarkScene manySpheresScene() {
+        BenchmarkScene scene;
+        scene.name = "spheres";
+        scene.sampleCount = 16;
+        scene.backgroundColor = Color3(0.7, 0.8, 1.0);
+        scene.cameraCenter = Point3(13.0, 2.0, 3.0);
+        scene.cameraTarget = Point3(0.0, 0.0, 0.0);
+        scene.fov = 35.0;
+        scene.focusDiskRadius = 0.1;
+
+        //函数参数的求值顺序不确定，随机数逐个取出，保证不同编译器生成相同的场景
+        RandomGenerator rng(BENCHMARK_SEED);
+        auto randomColor = [&rng](double min, double max) {
+            Color3 ret;
+            for (int i = 0; i < 3; i++) {
+                ret[i] = rng.nextDouble(min, max);
+            }
+            return ret;
+        };
+        scene.roughs.emplace_back(Color3(0.5, 0.5, 0.5));
+        scene.dielectrics.emplace_back(1.5);
+        scene.spheres.emplace_back(0, MaterialType::ROUGH, 0, Point3(0.0, -1000.0, 0.0), 1000.0);
+
+        for (int a = -11; a < 11; a++) {
+            for (int b = -11; b < 11; b++) {
+                const double offsetX = rng.nextDouble();
+                const double offsetZ = rng.nextDouble();
+                const Point3 center(a + 0.9 * offsetX, 0.2, b + 0.9 * offsetZ);
+                const double chooseMaterial = rng.nextDouble();
+                const size_t objectID = scene.spheres.size();
+                if (chooseMaterial < 0.8) {
+                    const Color3 albedo1 = randomColor(0.0, 1.0);
+                    const Color3 albedo2 = randomColor(0.0, 1.0);
+                    const Color3 albedo = albedo1 * albedo2;
+                    scene.spheres.emplace_back(objectID, MaterialType::ROUGH, scene.roughs.size(), center, 0.2);
+                    scene.roughs.emplace_back(albedo);
+                } else if (chooseMaterial < 0.95) {
+                    const Color3 albedo = randomColor(0.5, 1.0);
+                    const double fuzz = rng.nextDouble(0.0, 0.5);
+                    scene.spheres.emplace_back(objectID, MaterialType::METAL, scene.metals.size(), center, 0.2);
+                    scene.metals.emplace_back(albedo, fuzz);
+                } else {
+                    scene.spheres.emplace_back(objectID, MaterialType::DIELECTRIC, 0, center, 0.2);
+                }
+            }
+        }
+
+        scene.spheres.emplace_back(scene.spheres.size(), MaterialType::DIELECTRIC, 0, Point3(0.0, 1.0, 0.0), 1.0);
+        scene.spheres.emplace_back(scene.spheres.size(), MaterialType::ROUGH, scene.roughs.size(), Point3(-4.0, 1.0, 0.0), 1.0);
+        scene.roughs.emplace_back(Color3(0.4, 0.2, 0.1));
+        scene.spheres.emplace_back(scene.spheres.size(), MaterialType::METAL, scene.metals.size(), Point3(4.0, 1.0, 0.0), 1.0);
+        scene.metals.emplace_back(Color3(0.7, 0.6, 0.5), 0.0);
+        return scene;
+    }
+
+    //大型三角形网格：约26万个三角形的圆环，放置在地面上，由上方的面光源照明
+    BenchmarkScene largeMeshScene() {
+        BenchmarkScene scene;
+        scene.name = "mesh";
+        scene.sampleCount = 16;
+        scene.backgroundColor = Color3(0.05, 0.05, 0.08);
+        scene.cameraCenter = Point3(0.0, 2.5, -5.0);
+        scene.cameraTarget = Point3(0.0, 0.6, 0.0);
+        scene.fov = 50.0;
+
+        scene.roughs = {Rough(Color3(0.8, 0.3, 0.2)), Rough(Color3(0.73, 0.73, 0.73))};
+        scene.lights = {DiffuseLight(Color3(10.0, 10.0, 10.0))};
+
+        //圆环：主半径1.0，截面半径0.35，ringCount x sideCount个四边形，每个四边形两个三角形
+        const Uint32 ringCount = 256, sideCount = 512;
+        const double majorRadius = 1.0, minorRadius = 0.35;
+        scene.meshPositions.reserve(static_cast<size_t>(ringCount) * sideCount * 3);
+        for (Uint32 i = 0; i < ringCount; i++) {
+            const double theta = 2.0 * PI * i / ringCount;
+            for (Uint32 j = 0; j < sideCount; j++) {
+                const double phi = 2.0 * PI * j / sideCount;
+                const double radius = majorRadius + minorRadius * std::cos(phi);
+                scene.meshPositions.push_back(static_cast<float>(radius * std::cos(theta)));
+                scene.meshPositions.push_back(static_cast<float>(minorRadius * std::sin(phi) + 0.5));
+                scene.meshPositions.push_back(static_cast<float>(radius * std::sin(theta)));
+            }
+        }
+        scene.meshIndices.reserve(static_cast<size_t>(ringCount) * sideCount * 6);
+        for (Uint32 i = 0; i < ringCount; i++) {
+            for (Uint32 j = 0; j < sideCount; j++) {
+                const Uint32 i1 = (i + 1) % ringCount, j1 = (j + 1) % sideCount;
+                const Uint32 v00 = i * sideCount + j, v01 = i * sideCount + j1;
+                const Uint32 v10 = i1 * sideCount + j, v11 = i1 * sideCount + j1;
+                scene.meshIndices.insert(scene.meshIndices.end(), {v00, v10, v11, v00, v11, v01});
+            }
+        }
+        scene.meshes.emplace_back(MaterialType::ROUGH, 0, scene.meshPositions.data(), ringCount * sideCount,
+                                  scene.meshIndices.data(), static_cast<Uint32>(scene.meshIndices.size() / 3));
+
+        const Parallelogram light(1, MaterialType::DIFFUSE_LIGHT, 0, Point3(-1.0, 4.0, -1.0), Vec3(2.0, 0.0, 0.0), Vec3(0.0, 0.0, 2.0));
+        scene.parallelograms = {
+                Parallelogram(0, MaterialType::ROUGH, 1, Point3(-5.0, 0.0, 5.0), Vec3(10.0, 0.0, 0.0), Vec3(0.0, 0.0, -10.0)),
+                light
+        };
+        scene.hittableParallelograms = {light};
+        return scene;
+    }
+
+    //大量变换：16 x 16个高度和朝向各不相同的盒子，每个盒子通过独立的Transform放置
+    BenchmarkScene manyTransformsScene() {
+        BenchmarkScene scene;
+        scene.name = "transforms";
+        scene.sampleCount = 16;
+        scene.backgroundColor = Color3(0.7, 0.8, 1.0);
+        scene.cameraCenter = Point3(0.0, 8.0, -14.0);
+        scene.cameraTarget = Point3(0.0, 0.0, 0.0);
+        scene.fov = 60.0;
+
+        scene.roughs = {Rough(Color3(.65, .05, .05)), Rough(Color3(.73, .73, .73)), Rough(Color3(.12, .45, .15))};
+        scene.metals = {Metal(Color3(0.8, 0.85, 0.88), 0.2)};
+
+        //所有盒子构造完成后再构造Transform，避免数组扩容改变盒子的地址
+        RandomGenerator rng(BENCHMARK_SEED);
+        const int gridSize = 16;
+        std::vector<std::array<double, 3>> rotations, shifts;
+        for (int i = 0; i < gridSize; i++) {
+            for (int j = 0; j < gridSize; j++) {
+                const size_t index = scene.boxes.size();
+                const double height = rng.nextDouble(0.3, 1.5);
+                if (index % 4 == 3) {
+                    scene.boxes.emplace_back(MaterialType::METAL, 0, Point3(), Point3(0.6, height, 0.6));
+                } else {
+                    scene.boxes.emplace_back(MaterialType::ROUGH, index % 3, Point3(), Point3(0.6, height, 0.6));
+                }
+                rotations.push_back({0.0, rng.nextDouble(0.0, 90.0), 0.0});
+                shifts.push_back({j - gridSize / 2 + 0.2, 0.0, i - gridSize / 2 + 0.2});
+            }
+        }
+        for (size_t i = 0; i < scene.boxes.size(); i++) {
+            scene.transforms.emplace_back(scene.boxes.data(), PrimitiveType::BOX, i, scene.boxes[i].constructBoundingBox(), scene.boxes[i].centroid(),
+                                          rotations[i], shifts[i]);
+        }
+
+        scene.parallelograms = {
+                Parallelogram(0, MaterialType::ROUGH, 1, Point3(-20.0, 0.0, 20.0), Vec3(40.0, 0.0, 0.0), Vec3(0.0, 0.0, -40.0))
+        };
+        return scene;
+    }
+
+    //大量光源：天花板上8 x 8个颜色和亮度各不相同的面光源，测试光源采样的开销
+    BenchmarkScene manyLightsScene() {
+        BenchmarkScene scene;
+        scene.name = "lights";
+        scene.sampleCount = 16;
+        scene.cameraCenter = Point3(0.0, 2.0, -9.0);
+        scene.cameraTarget = Point3(0.0, 1.5, 0.0);
+        scene.fov = 70.0;
+
+        scene.roughs = {Rough(Color3(0.73, 0.73, 0.73)), Rough(Color3(0.2, 0.4, 0.7))};
+        scene.metals = {Metal(Color3(0.9, 0.9, 0.9), 0.05)};
+
+        scene.parallelograms = {
+                Parallelogram(0, MaterialType::ROUGH, 0, Point3(-5.0, 0.0, 5.0), Vec3(10.0, 0.0, 0.0), Vec3(0.0, 0.0, -10.0)),
+                Parallelogram(1, MaterialType::ROUGH, 0, Point3(-5.0, 4.0, -5.0), Vec3(10.0, 0.0, 0.0), Vec3(0.0, 0.0, 10.0))
+        };
+
+        RandomGenerator rng(BENCHMARK_SEED);
+        const int gridSize = 8;
+        for (int i = 0; i < gridSize; i++) {
+            for (int j = 0; j < gridSize; j++) {
+                const double intensity = rng.nextDouble(2.0, 20.0);
+                Color3 color;
+                for (int k = 0; k < 3; k++) {
+                    color[k] = rng.nextDouble(0.2, 1.0);
+                }
+                const Parallelogram light(scene.parallelograms.size(), MaterialType::DIFFUSE_LIGHT, scene.lights.size(),
+                                          Point3(j - gridSize / 2 + 0.35, 3.99, i - gridSize / 2 + 0.35), Vec3(0.3, 0.0, 0.0), Vec3(0.0, 0.0, 0.3));
+                scene.lights.emplace_back(color * intensity);
+                scene.parallelograms.push_back(light);
+                scene.hittableParallelograms.push_back(light);
+            }
+        }
+
+        scene.spheres = {
+                Sphere(0, MaterialType::ROUGH, 1, Point3(-2.0, 0.8, 0.0), 0.8),
+                Sphere(1, MaterialType::METAL, 0, Point3(0.0, 0.8, 1.0), 0.8),
+                Sphere(2, MaterialType::ROUGH, 0, Point3(2.0, 0.8, 0.0), 0.8)
+        };
+        return scene;
+    }
+
+    typedef BenchmarkScene (*SceneFactory)();
+    const std::pair<const char *, SceneFactory> SCENE_FACTORIES[] = {
+            {"cornell", cornellBoxScene},
+            {"spheres", manySpheresScene},
+            {"mesh", largeMeshScene},
+            {"transforms", manyTransformsScene},
+            {"lights", manyLightsScene}
+    };
+
+    // ====== 测试和输出 ======
+
+    BenchmarkResult runScene(BenchmarkScene & scene, const CommandLineOptions & options) {
+        const Uint32 sampleCount = options.sampleCount > 0 ? options.sampleCount : scene.sampleCount;
+        Camera cam(BENCHMARK_WIDTH, BENCHMARK_HEIGHT, scene.backgroundColor,
+                   scene.cameraCenter, scene.cameraTarget, scene.fov, scene.focusDiskRadius,
+                   Range(0.0, 1.0), sampleCount, 0.5, BENCHMARK_DEPTH, Vec3(0.0, 1.0, 0.0));
+        cam.seed = BENCHMARK_SEED;
+        if (options.threadCount > 0) {
+            cam.threadCount = options.threadCount;
+        }
+
+        //相机使用sqrtSampleCount x sqrtSampleCount的分层采样，实际采样数为不超过sampleCount的最大平方数
+        const auto renderedSampleCount = static_cast<Uint32>(cam.sqrtSampleCount * cam.sqrtSampleCount);
+
+        //网格内部BVH的构建时间计入BVH构建时间
+        BVHBuildOptions bvhOptions;
+        bvhOptions.threadCount = cam.threadCount;
+        const Uint32 meshBuildStartTick = SDL_GetTicks();
+        scene.meshBVHs = BVHTree::constructMeshBVH(scene.meshes, bvhOptions);
+        const Uint32 meshBuildTime = SDL_GetTicks() - meshBuildStartTick;
+
+        SDL_Log("Benchmark scene: %s, Primitives: %zu, Samples: %u, Threads: %u",
+                scene.name.c_str(), scene.primitiveCount(), renderedSampleCount, cam.threadCount);
+        FrameBuffer frameBuffer(cam.windowWidth, cam.windowHeight);
+        BenchmarkResult result;
+        result.totalTime = render(cam, frameBuffer, nullptr,
+                                  scene.roughs.data(), scene.metals.data(), scene.lights.data(), scene.dielectrics.data(),
+                                  scene.spheres.data(), static_cast<Uint32>(scene.spheres.size()),
+                                  nullptr, 0,
+                                  scene.parallelograms.data(), static_cast<Uint32>(scene.parallelograms.size()),
+                                  scene.transforms.data(), static_cast<Uint32>(scene.transforms.size()),
+                                  nullptr, 0,
+                                  scene.meshes.data(), static_cast<Uint32>(scene.meshes.size()),
+                                  scene.hittableSpheres.data(), scene.hittableSpheres.size(),
+                                  scene.hittableParallelograms.data(), scene.hittableParallelograms.size(),
+                                  &result.statistics) + meshBuildTime;
+        result.statistics.bvhBuildTime += meshBuildTime;
+        result.name = scene.name;
+        result.sampleCount = renderedSampleCount;
+        result.primitiveCount = scene.primitiveCount();
+        result.peakMemoryKB = peakMemoryKB();
+        return result;
+    }
+
+    //每秒百万光线数，时间为0时返回0
+    double megaRaysPerSecond(Uint64 rayCount, Uint32 milliseconds) {
+        return milliseconds > 0 ? static_cast<double>(rayCount) / (milliseconds * 1000.0) : 0.0;
+    }
+
+    /*
+     * 以JSON格式输出测试结果
+     * 时间单位为毫秒，peak_memory_kb为进程启动以来的峰值常驻内存，按场景的运行顺序单调不减
+     * 启用遍历统计时额外输出节点访问数、图元相交测试数、光路线段数和阴影光线数，计数本身会降低光线吞吐量
+     */
+    void writeResults(FILE * file, const std::vector<BenchmarkResult> & results, Uint32 threadCount) {
+        fprintf(file, "{\n");
+        fprintf(file, "  \"width\": %u,\n  \"height\": %u,\n  \"seed\": %llu,\n  \"max_depth\": %u,\n  \"threads\": %u,\n",
+                BENCHMARK_WIDTH, BENCHMARK_HEIGHT, static_cast<unsigned long long>(BENCHMARK_SEED), BENCHMARK_DEPTH, threadCount);
+        fprintf(file, "  \"scenes\": [");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult & result = results[i];
+            const RenderStatistics & statistics = result.statistics;
+            const Uint64 totalRayCount = statistics.primaryRayCount + statistics.secondaryRayCount;
+            fprintf(file, "%s\n    {\n", i == 0 ? "" : ",");
+            fprintf(file, "      \"name\": \"%s\",\n", result.name.c_str());
+            fprintf(file, "      \"spp\": %u,\n", result.sampleCount);
+            fprintf(file, "      \"primitives\": %zu,\n", result.primitiveCount);
+            fprintf(file, "      \"bvh_build_ms\": %u,\n", statistics.bvhBuildTime);
+            fprintf(file, "      \"sample_ms\": %u,\n", statistics.sampleTime);
+            fprintf(file, "      \"denoise_ms\": %u,\n", statistics.denoiseTime);
+            fprintf(file, "      \"total_ms\": %u,\n", result.totalTime);
+            fprintf(file, "      \"primary_rays\": %llu,\n", static_cast<unsigned long long>(statistics.primaryRayCount));
+            fprintf(file, "      \"secondary_rays\": %llu,\n", static_cast<unsigned long long>(statistics.secondaryRayCount));
+            fprintf(file, "      \"primary_mrays_per_s\": %.3lf,\n", megaRaysPerSecond(statistics.primaryRayCount, statistics.sampleTime));
+            fprintf(file, "      \"secondary_mrays_per_s\": %.3lf,\n", megaRaysPerSecond(statistics.secondaryRayCount, statistics.sampleTime));
+            fprintf(file, "      \"total_mrays_per_s\": %.3lf,\n", megaRaysPerSecond(totalRayCount, statistics.sampleTime));
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+            const TraversalCounters & traversal = statistics.traversal;
+            fprintf(file, "      \"nodes_visited\": %llu,\n", static_cast<unsigned long long>(traversal.nodeCount));
+            fprintf(file, "      \"primitive_tests\": %llu,\n", static_cast<unsigned long long>(traversal.primitiveTestCount()));
+            fprintf(file, "      \"mesh_triangle_tests\": %llu,\n", static_cast<unsigned long long>(traversal.meshTriangleTestCount));
+            fprintf(file, "      \"bounces\": %llu,\n", static_cast<unsigned long long>(traversal.bounceCount));
+            fprintf(file, "      \"shadow_rays\": %llu,\n", static_cast<unsigned long long>(traversal.shadowRayCount));
+#endif
+            fprintf(file, "      \"peak_memory_kb\": %llu\n", static_cast<unsigned long long>(result.peakMemoryKB));
+            fprintf(file, "    }");
+        }
+        fprintf(file, "\n  ]\n}\n");
+    }
+
+    bool parseUint32(const char * str, Uint32 & value) {
+        char * end;
+        const unsigned long result = strtoul(str, &end, 10);
+        if (*str == '\0' || *str == '-' || *end != '\0' || result > std::numeric_limits<Uint32>::max()) {
+            return false;
+        }
+        value = static_cast<Uint32>(result);
+        return true;
+    }
+
+    bool isKnownScene(const std::string & name) {
+        for (const auto & factory : SCENE_FACTORIES) {
+            if (name == factory.first) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    CommandLineOptions parseCommandLine(int argc, char * argv[]) {
+        CommandLineOptions ret;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg(argv[i]);
+            if (arg == "--scene" && i + 1 < argc && isKnownScene(argv[i + 1])) {
+                ret.sceneNames.emplace_back(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc && parseUint32(argv[i + 1], ret.threadCount)) {
+                i++;
+            } else if (arg == "--spp" && i + 1 < argc && parseUint32(argv[i + 1], ret.sampleCount)) {
+                i++;
+            } else if (arg == "--output" && i + 1 < argc) {
+                ret.outputPath = argv[++i];
+            } else if (arg == "--list") {
+                ret.isListOnly = true;
+            } else {
+                SDL_Log("Usage: %s [--scene cornell|spheres|mesh|transforms|lights]... [--threads N] [--spp N] "
+                        "[--output file.json] [--list]", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        return ret;
+    }
+
+    void releaseSDLResourcesImpl() {
+        releaseSDLResource(SDL_Quit(), "Quit");
+    }
+}
+
+int main(int argc, char * argv[]) {
+    const CommandLineOptions options = parseCommandLine(argc, argv);
+    if (options.isListOnly) {
+        for (const auto & factory : SCENE_FACTORIES) {
+            printf("%s\n", factory.first);
+        }
+        return 0;
+    }
+
+    registerReleaseSDLResources(releaseSDLResourcesImpl);
+    sdlCheckErrorInt(SDL_Init(0), "Init", EXIT_PROGRAM);
+
+    std::vector<BenchmarkResult> results;
+    const Uint32 threadCount = options.threadCount > 0 ? options.threadCount : static_cast<Uint32>(ThreadPool::hardwareThreadCount());
+    for (const auto & factory : SCENE_FACTORIES) {
+        if (!options.sceneNames.empty() &&
+            std::find(options.sceneNames.begin(), options.sceneNames.end(), factory.first) == options.sceneNames.end()) {
+            continue;
+        }
+        BenchmarkScene scene = factory.second();
+        results.push_back(runScene(scene, options));
+    }
+
+    FILE * file = options.outputPath.empty() ? stdout : fopen(options.outputPath.c_str(), "w");
+    if (file == nullptr) {
+        SDL_Log("Failed to open output file: %s", options.outputPath.c_str());
+        releaseSDLResourcesImpl();
+        return EXIT_FAILURE;
+    }
+    writeResults(file, results, threadCount);
+    if (file != stdout) {
+        fclose(file);
+        SDL_Log("Benchmark results saved: %s", options.outputPath.c_str());
+    }
+
+    releaseSDLResourcesImpl();
+    return 0;
+}
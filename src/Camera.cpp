@@ -1,19 +1,23 @@
 #include <Camera.hpp>
+#include <util/ThreadPool.hpp>
 
 namespace renderer {
     Camera::Camera(Uint32 windowWidth, Uint32 windowHeight, const Color3 & backgroundColor,
-            const Point3 & center, const Point3 & target, double fov, double focusDiskRadius,
-            const Range & shutterRange, Uint32 sampleCount, double sampleRange,
+            const Point3 & center, const Point3 & target, Real fov, Real focusDiskRadius,
+            const Range & shutterRange, Uint32 sampleCount, Real sampleRange,
             Uint32 rayTraceDepth, const Vec3 & upDirection) :
     windowWidth(windowWidth), windowHeight(windowHeight), backgroundColor(backgroundColor),
     cameraCenter(center), cameraTarget(target), horizontalFOV(fov), focusDiskRadius(focusDiskRadius),
     shutterRange(shutterRange), sampleCount(sampleCount), sampleRange(sampleRange),
-    rayTraceDepth(rayTraceDepth), focusDistance(Point3::distance(cameraCenter, cameraTarget)),
+    rayTraceDepth(rayTraceDepth), russianRouletteDepth(3), focusDistance(Point3::distance(cameraCenter, cameraTarget)),
+    tileSize(32), threadCount(static_cast<Uint32>(ThreadPool::hardwareThreadCount())), seed(0), samplerType(SamplerType::SOBOL),
+    samplesPerPass(0), denoisePassInterval(0), timeLimit(0),
+    adaptiveThreshold(0.0), adaptiveMinSampleCount(64), adaptiveMaxSampleCount(0),
     denoiser(Denoiser(windowWidth, windowHeight))
     {
-        const double thetaFOV = degreeToRadian(horizontalFOV);
-        const double vWidth = 2.0 * tan(thetaFOV / 2.0) * focusDistance;
-        const double vHeight = vWidth / (windowWidth * 1.0 / windowHeight);
+        const Real thetaFOV = degreeToRadian(horizontalFOV);
+        const Real vWidth = 2.0 * tan(thetaFOV / 2.0) * focusDistance;
+        const Real vHeight = vWidth / (windowWidth * 1.0 / windowHeight);
 
         this->viewPortWidth = vWidth;
         this->viewPortHeight = vHeight;
@@ -33,17 +37,13 @@ namespace renderer {
         this->pixelOrigin = viewPortOrigin + viewPortPixelDx * 0.5 + viewPortPixelDy * 0.5;
 
         this->sqrtSampleCount = static_cast<size_t>(sqrt(sampleCount));
-        this->reciprocalSqrtSampleCount = 1.0 / static_cast<double>(sqrtSampleCount);
-
-        this->normalList = std::vector<Vec3>(sqrtSampleCount * sqrtSampleCount, Vec3());
-        this->albedoList = std::vector<Color3>(sqrtSampleCount * sqrtSampleCount, Color3());
-        this->isRecordList = std::vector<bool>(sqrtSampleCount * sqrtSampleCount, false);
+        this->reciprocalSqrtSampleCount = 1.0 / static_cast<Real>(sqrtSampleCount);
     }
 
     std::string Camera::toString() const {
         std::string ret("Renderer Camera:\n");
-        char buffer[4 * TOSTRING_BUFFER_SIZE] = { 0 };
-        snprintf(buffer, 4 * TOSTRING_BUFFER_SIZE,
+        char buffer[8 * TOSTRING_BUFFER_SIZE] = { 0 };
+        snprintf(buffer, 8 * TOSTRING_BUFFER_SIZE,
                  "\tWindow Size: %u x %u\n\tBackground Color: %s\n\t"
                  "Camera Direction: %s --> %s, FOV: %.4lf\n\t"
                  "Viewport Size: %.4lf x %.4lf\n\t"
@@ -52,14 +52,19 @@ namespace renderer {
                  "Viewport Origin: %s, Pixel Origin: %s\n\t"
                  "Sample Disk Radius: %.4lf, Focus Distance: %.4lf\n\t"
                  "Shutter %s\n\tSSAA Sample Count: %u, Range: %.2lf\n\t"
-                 "Raytrace Depth: %u",
+                 "Raytrace Depth: %u, Russian Roulette Depth: %u\n\tTile Size: %u, Thread Count: %u, Seed: %llu, Sampler: %s\n\t"
+                 "Samples Per Pass: %u, Denoise Pass Interval: %u, Time Limit: %u ms\n\t"
+                 "Adaptive Threshold: %.4lf, Sample Count: %u ~ %u",
                  windowWidth, windowHeight, backgroundColor.toString().c_str(),
                  cameraCenter.toString().c_str(), cameraTarget.toString().c_str(),
                  horizontalFOV, viewPortWidth, viewPortHeight,
                  cameraU.toString().c_str(), cameraV.toString().c_str(), cameraW.toString().c_str(),
                  viewPortPixelDx.toString().c_str(), viewPortPixelDy.toString().c_str(),
                  viewPortOrigin.toString().c_str(), pixelOrigin.toString().c_str(),
-                 focusDiskRadius, focusDistance, shutterRange.toString().c_str(), sampleCount, sampleRange, rayTraceDepth
+                 focusDiskRadius, focusDistance, shutterRange.toString().c_str(), sampleCount, sampleRange, rayTraceDepth, russianRouletteDepth,
+                 tileSize, threadCount, static_cast<unsigned long long>(seed), samplerType == SamplerType::SOBOL ? "Sobol" : "Independent",
+                 samplesPerPass, denoisePassInterval, timeLimit,
+                 adaptiveThreshold, adaptiveMinSampleCount, adaptiveMaxSampleCount
         );
         return ret + buffer;
     }
@@ -1,19 +1,49 @@
 #include <Render.hpp>
+#include <util/ObjLoader.hpp>
+#include <util/ImageWriter.hpp>
 
 using namespace renderer;
 
 namespace {
     constexpr Uint32 WINDOW_WIDTH = 800;
     constexpr Uint32 WINDOW_HEIGHT = 450;
-    SDL_Window * window = nullptr;
-    SDL_Surface * surface = nullptr;
+    std::unique_ptr<Viewer> viewer;
 
-    void initSDLResources();
+    /*
+     * 命令行参数：[--headless] [--output 文件路径]... [--samples-per-pass N] [--denoise-interval K] [--time-limit 毫秒]
+     *           [--adaptive-threshold 阈值] [--adaptive-min N] [--adaptive-max N]
+     *           [--max-depth N] [--rr-depth N] [--sampler sobol|independent] [OBJ文件路径]
+     */
+    struct CommandLineOptions {
+        bool isHeadless = false;              //不创建窗口，渲染完成后只写入文件
+        std::vector<std::string> outputPaths; //可以指定多个输出文件，格式由扩展名决定（.png、.pfm、.exr）
+        std::string objPath;
+
+        //渐进式渲染参数，含义同Camera的对应属性
+        Uint32 samplesPerPass = 0;
+        Uint32 denoisePassInterval = 0;
+        Uint32 timeLimit = 0;
+
+        //自适应采样参数，含义同Camera的对应属性，最小和最大采样数为0时使用Camera的默认值
+        double adaptiveThreshold = 0.0;
+        Uint32 adaptiveMinSampleCount = 0;
+        Uint32 adaptiveMaxSampleCount = 0;
+
+        //光线追踪深度和俄罗斯轮盘赌的起始深度，为0时使用Camera的默认值
+        Uint32 rayTraceDepth = 0;
+        Uint32 russianRouletteDepth = 0;
+
+        SamplerType samplerType = SamplerType::SOBOL;
+    };
+
+    CommandLineOptions parseCommandLine(int argc, char * argv[]);
+    void initSDLResources(bool isHeadless);
     void releaseSDLResourcesImpl();
 }
 
 int main(int argc, char * argv[]) {
-    initSDLResources();
+    const CommandLineOptions options = parseCommandLine(argc, argv);
+    initSDLResources(options.isHeadless);
 
 //    const Camera cam(
 //            WINDOW_WIDTH, WINDOW_HEIGHT, Color3(0.7, 0.8, 1.0),
@@ -130,11 +160,45 @@ int main(int argc, char * argv[]) {
             Transform(boxes, PrimitiveType::BOX, 1, boxes[1].constructBoundingBox(), boxes[1].centroid(), std::array<double, 3>{0.0, 18.0, 0.0}, std::array<double, 3>{265.0, 0.0, 295.0}/*, std::array<double, 3>{1.5, 1.5, 1.5}*/)
     };
 
+    //命令行传入OBJ文件时加载模型，模型材质追加在场景材质之后
+    std::vector<Rough> roughVector(roughs, roughs + arrayLengthOnPos(roughs));
+    std::vector<DiffuseLight> lightVector(lights, lights + arrayLengthOnPos(lights));
+    ObjModel model;
+    if (!options.objPath.empty()) {
+        const Uint32 loadStartTick = SDL_GetTicks();
+        BVHBuildOptions bvhOptions;
+        bvhOptions.threadCount = cam.threadCount;
+        model = ObjLoader::load(options.objPath, ObjLoadOptions(static_cast<Uint32>(roughVector.size()), static_cast<Uint32>(lightVector.size()), bvhOptions));
+        roughVector.insert(roughVector.end(), model.roughMaterials.begin(), model.roughMaterials.end());
+        lightVector.insert(lightVector.end(), model.lightMaterials.begin(), model.lightMaterials.end());
+        SDL_Log("OBJ loaded: %s. Meshes: %zu, Triangles: %zu, Time: %u ms",
+                options.objPath.c_str(), model.meshes.size(), model.triangleCount(), SDL_GetTicks() - loadStartTick);
+    }
+
+    cam.samplesPerPass = options.samplesPerPass;
+    cam.denoisePassInterval = options.denoisePassInterval;
+    cam.timeLimit = options.timeLimit;
+    cam.adaptiveThreshold = options.adaptiveThreshold;
+    if (options.adaptiveMinSampleCount > 0) {
+        cam.adaptiveMinSampleCount = options.adaptiveMinSampleCount;
+    }
+    if (options.adaptiveMaxSampleCount > 0) {
+        cam.adaptiveMaxSampleCount = options.adaptiveMaxSampleCount;
+    }
+    if (options.rayTraceDepth > 0) {
+        cam.rayTraceDepth = options.rayTraceDepth;
+    }
+    if (options.russianRouletteDepth > 0) {
+        cam.russianRouletteDepth = options.russianRouletteDepth;
+    }
+    cam.samplerType = options.samplerType;
+
+    FrameBuffer frameBuffer(cam.windowWidth, cam.windowHeight);
     SDL_Log("Render Start...");
     SDL_Log("Render completed. Time: %u ms",
-            render(cam, window, surface,
-                    roughs, metals,
-                    lights, dielectrics,
+            render(cam, frameBuffer, viewer.get(),
+                    roughVector.data(), metals,
+                    lightVector.data(), dielectrics,
                     //Sphere
                     spheres, arrayLengthOnPos(spheres),
                     //nullptr, 0,
@@ -148,35 +212,114 @@ int main(int argc, char * argv[]) {
                     //Box
                     //boxes, arrayLengthOnPos(boxes),
                     nullptr, 0,
+                    //TriangleMesh
+                    model.meshes.data(), static_cast<Uint32>(model.meshes.size()),
 
                     //HittablePDF
                     hittableSphere, arrayLengthOnPos(hittableSphere),
                     hittableParallelogram, arrayLengthOnPos(hittableParallelogram))
     );
 
-    SDL_UpdateWindowSurface(window);
-    SDL_Delay(1000 * 3);
+    if (viewer != nullptr) {
+        viewer->update();
+        SDL_Delay(1000 * 3);
+    }
 
     //保存渲染结果
-    IMG_SavePNG(surface, "../files/output.png");
+    for (const auto & outputPath : options.outputPaths) {
+        ImageWriter::save(frameBuffer, outputPath);
+        SDL_Log("Image saved: %s", outputPath.c_str());
+    }
 
     releaseSDLResourcesImpl();
     return 0;
 }
 
 namespace {
-    void initSDLResources() {
+    bool parseUint32(const char * str, Uint32 & value) {
+        char * end;
+        const unsigned long result = strtoul(str, &end, 10);
+        if (*str == '\0' || *str == '-' || *end != '\0' || result > std::numeric_limits<Uint32>::max()) {
+            return false;
+        }
+        value = static_cast<Uint32>(result);
+        return true;
+    }
+
+    bool parseDouble(const char * str, double & value) {
+        char * end;
+        const double result = strtod(str, &end);
+        if (*str == '\0' || *end != '\0' || !(result >= 0.0)) {
+            return false;
+        }
+        value = result;
+        return true;
+    }
+
+    bool parseSamplerType(const char * str, SamplerType & value) {
+        const std::string name(str);
+        if (name == "sobol") {
+            value = SamplerType::SOBOL;
+        } else if (name == "independent") {
+            value = SamplerType::INDEPENDENT;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    CommandLineOptions parseCommandLine(int argc, char * argv[]) {
+        CommandLineOptions ret;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg(argv[i]);
+            if (arg == "--headless") {
+                ret.isHeadless = true;
+            } else if (arg == "--output" && i + 1 < argc) {
+                ret.outputPaths.emplace_back(argv[++i]);
+            } else if (arg == "--samples-per-pass" && i + 1 < argc && parseUint32(argv[i + 1], ret.samplesPerPass)) {
+                i++;
+            } else if (arg == "--denoise-interval" && i + 1 < argc && parseUint32(argv[i + 1], ret.denoisePassInterval)) {
+                i++;
+            } else if (arg == "--time-limit" && i + 1 < argc && parseUint32(argv[i + 1], ret.timeLimit)) {
+                i++;
+            } else if (arg == "--adaptive-threshold" && i + 1 < argc && parseDouble(argv[i + 1], ret.adaptiveThreshold)) {
+                i++;
+            } else if (arg == "--adaptive-min" && i + 1 < argc && parseUint32(argv[i + 1], ret.adaptiveMinSampleCount)) {
+                i++;
+            } else if (arg == "--adaptive-max" && i + 1 < argc && parseUint32(argv[i + 1], ret.adaptiveMaxSampleCount)) {
+                i++;
+            } else if (arg == "--max-depth" && i + 1 < argc && parseUint32(argv[i + 1], ret.rayTraceDepth)) {
+                i++;
+            } else if (arg == "--rr-depth" && i + 1 < argc && parseUint32(argv[i + 1], ret.russianRouletteDepth)) {
+                i++;
+            } else if (arg == "--sampler" && i + 1 < argc && parseSamplerType(argv[i + 1], ret.samplerType)) {
+                i++;
+            } else if (arg.compare(0, 2, "--") != 0 && ret.objPath.empty()) {
+                ret.objPath = arg;
+            } else {
+                SDL_Log("Usage: %s [--headless] [--output file.png|file.pfm|file.exr]... "
+                        "[--samples-per-pass N] [--denoise-interval K] [--time-limit ms] "
+                        "[--adaptive-threshold error] [--adaptive-min N] [--adaptive-max N] "
+                        "[--max-depth N] [--rr-depth N] [--sampler sobol|independent] [model.obj]", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (ret.outputPaths.empty()) {
+            ret.outputPaths.emplace_back("../files/output.png");
+        }
+        return ret;
+    }
+
+    void initSDLResources(bool isHeadless) {
         registerReleaseSDLResources(releaseSDLResourcesImpl);
         int ret;
 
-        //初始化SDL库
-        ret = SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_EVENTS);
+        //初始化SDL库，无窗口模式不初始化视频子系统，可以在没有显示设备的机器上运行
+        ret = SDL_Init(isHeadless ? 0 : SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_EVENTS);
         sdlCheckErrorInt(ret, "Init", EXIT_PROGRAM);
-        window = SDL_CreateWindow("Test", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                  WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
-        sdlCheckErrorPtr(window, "Create Window", EXIT_PROGRAM);
-        surface = SDL_GetWindowSurface(window);
-        sdlCheckErrorPtr(surface, "Get Surface", EXIT_PROGRAM);
+        if (!isHeadless) {
+            viewer.reset(new Viewer(WINDOW_WIDTH, WINDOW_HEIGHT, "Test"));
+        }
 
         //初始化图像库
         ret = IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
@@ -184,17 +327,11 @@ namespace {
 
         //打印SDL信息
         SDL_Log("SDL Version: %d.%d.%d", SDL_MAJOR_VERSION, SDL_MINOR_VERSION, SDL_PATCHLEVEL);
-        SDL_Log("SDL Color Format: %s", SDL_GetPixelFormatName(surface->format->format));
     }
 
     void releaseSDLResourcesImpl() {
         releaseSDLResource(IMG_Quit(), "Quit IMG");
-        if (surface != nullptr) {
-            releaseSDLResource(SDL_FreeSurface(surface), "Free Surface");
-        }
-        if (window != nullptr) {
-            releaseSDLResource(SDL_DestroyWindow(window), "Destroy Window");
-        }
+        viewer.reset();
         releaseSDLResource(SDL_Quit(), "Quit");
     }
-}
+}
\ No newline at end of file
@@ -0,0 +1,471 @@
+#include <Render.hpp>
+
+using namespace renderer;
+
+/*
+ * 相交测试内核的微基准测试程序
+ * 对每个内核使用固定种子生成的随机光线批量重复调用，输出每次测试的平均纳秒数，不运行完整的渲染
+ * 每个内核分为两种光线批次：
+ *   hit  光线从包围球外射向物体包围盒内的随机点，大部分光线命中（命中率取决于物体占包围盒的比例）
+ *   miss 光线从物体旁经过，与物体的包围球的距离大于包围球半径，全部不命中，测量提前退出路径的开销
+ * 同一内核的不同实现注册为不同的variant，在同一次运行中直接比较；
+ * 不同编译选项（AVX2、浮点精度等）之间的比较通过--baseline读取另一次运行输出的CSV，输出每项的加速比
+ *
+ * 命令行参数：[--filter 内核名]... [--rays N] [--min-time 毫秒] [--output 文件路径] [--baseline 文件路径] [--list]
+ *   --filter   只运行名称包含指定字符串的内核，可以指定多个
+ *   --rays     每个批次的光线数，默认4096条，约360KB，位于L2/L3缓存中，测量结果以计算为主而不是内存带宽
+ *   --min-time 每个内核、每种批次的最短计时时间，默认200毫秒，分为多轮取最快一轮
+ *   --output   CSV输出文件，默认输出到标准输出
+ *   --baseline 作为基准的CSV文件，按kernel、variant、case匹配，额外输出基准耗时和加速比
+ */
+namespace {
+    constexpr Uint64 MICRO_BENCHMARK_SEED = 1;
+    constexpr Uint32 DEFAULT_RAY_COUNT = 4096;
+    constexpr Uint32 DEFAULT_MIN_TIME = 200;
+    constexpr Uint32 MEASURE_ROUND_COUNT = 5;
+
+    //光线起点到物体中心的距离，以包围盒半对角线长度为单位
+    constexpr double ORIGIN_DISTANCE = 4.0;
+
+    /*
+     * 所有内核共用的测试对象，均以原点为中心，尺寸为单位量级
+     * Transform引用boxes数组中的元素，因此对象创建后不能拷贝或移动
+     */
+    struct KernelObjects {
+        Sphere sphere;
+        Triangle triangle;
+        Parallelogram parallelogram;
+        std::vector<Box> boxes;
+        Transform transform;
+
+        //四个子包围盒，分别按标量BoundingBox和四叉宽节点两种方式测试
+        BoundingBox childBoxes[BVHWideNode::WIDTH];
+        BVHWideNode wideNode;
+
+        //颜色写入测试的输入颜色和目标像素格式，颜色分量超出1.0以覆盖截断分支
+        std::vector<Color3> colors;
+        std::vector<Uint32> pixels;
+        SDL_PixelFormat * pixelFormat;
+
+        KernelObjects() :
+                sphere(0, MaterialType::ROUGH, 0, Point3(), 1.0),
+                triangle(0, MaterialType::ROUGH, 0, Point3(-1.0, -1.0, 0.0), Point3(1.0, -1.0, 0.0), Point3(0.0, 1.0, 0.0)),
+                parallelogram(0, MaterialType::ROUGH, 0, Point3(-1.0, -1.0, 0.0), Vec3(2.0, 0.0, 0.0), Vec3(0.0, 2.0, 0.0)),
+                boxes {Box(MaterialType::ROUGH, 0, Point3(-1.0, -1.0, -1.0), Point3(1.0, 1.0, 1.0))},
+                transform(boxes.data(), PrimitiveType::BOX, 0, boxes[0].constructBoundingBox(), boxes[0].centroid(),
+                          std::array<double, 3>{30.0, 45.0, 0.0}, std::array<double, 3>{}, std::array<double, 3>{0.5, 1.0, 0.75}),
+                wideNode(), pixelFormat(nullptr)
+        {
+            //子包围盒为[-1, 1]^3在x、y方向上的四个象限，z方向的范围互不相同，边界值都可以用float精确表示
+            wideNode.clear();
+            for (Uint32 i = 0; i < BVHWideNode::WIDTH; i++) {
+                const double x = (i & 1u) ? 0.0 : -1.0;
+                const double y = (i & 2u) ? 0.0 : -1.0;
+                const double z = 0.25 * i;
+                childBoxes[i] = BoundingBox(Point3(x, y, -1.0 + z), Point3(x + 1.0, y + 1.0, 1.0 - z));
+                for (int axis = 0; axis < 3; axis++) {
+                    wideNode.bounds[axis][i] = static_cast<float>(childBoxes[i][axis].min);
+                    wideNode.bounds[axis + 3][i] = static_cast<float>(childBoxes[i][axis].max);
+                }
+                wideNode.index[i] = i;
+                wideNode.primitiveCount[i] = 1;
+            }
+        }
+
+        KernelObjects(const KernelObjects & obj) = delete;
+        KernelObjects & operator=(const KernelObjects & obj) = delete;
+    };
+
+    /*
+     * 内核运行函数：对批次中的每条光线调用一次内核，返回命中次数
+     * 命中结果和交点参数累加到checksum，防止编译器删除未使用的计算
+     */
+    typedef Uint64 (*KernelFunction)(const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum);
+
+    //测试对象的包围盒，用于生成光线批次
+    typedef BoundingBox (*KernelTarget)(const KernelObjects & objects);
+
+    struct MicroKernel {
+        const char * name;
+        const char * variant;
+        Uint32 testsPerRay;     //每条光线的测试次数，如宽节点一次测试4个包围盒
+        KernelTarget target;    //为nullptr时内核不使用光线（颜色写入），只运行一种批次
+        KernelFunction function;
+    };
+
+    const Range RAY_RANGE(0.0, INFINITY);
+
+    // ====== 内核 ======
+
+    //hit(Ray, Range, HitRecord&)形式的图元相交测试
+    template<typename T>
+    Uint64 primitiveHits(const T & primitive, const std::vector<TraversalRay> & rays, double & checksum) {
+        Uint64 hitCount = 0;
+        HitRecord record;
+        for (const auto & ray : rays) {
+            if (primitive.hit(static_cast<const Ray &>(ray), RAY_RANGE, record)) {
+                hitCount++;
+                checksum += record.t + record.normalVector[0];
+            }
+        }
+        return hitCount;
+    }
+
+    const MicroKernel KERNELS[] = {
+            {"Sphere::hit", "default", 1,
+             [](const KernelObjects & objects) { return objects.sphere.constructBoundingBox(); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 return primitiveHits(objects.sphere, rays, checksum);
+             }},
+            {"Triangle::hit", "default", 1,
+             [](const KernelObjects & objects) { return objects.triangle.constructBoundingBox(); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 return primitiveHits(objects.triangle, rays, checksum);
+             }},
+            {"Parallelogram::hit", "default", 1,
+             [](const KernelObjects & objects) { return objects.parallelogram.constructBoundingBox(); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 return primitiveHits(objects.parallelogram, rays, checksum);
+             }},
+            //Ray重载在每次调用时计算方向的倒数，TraversalRay重载使用BVH遍历时已缓存的倒数
+            {"Box::hit", "ray", 1,
+             [](const KernelObjects & objects) { return objects.boxes[0].constructBoundingBox(); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 return primitiveHits(objects.boxes[0], rays, checksum);
+             }},
+            {"Box::hit", "traversal", 1,
+             [](const KernelObjects & objects) { return objects.boxes[0].constructBoundingBox(); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 Uint64 hitCount = 0;
+                 HitRecord record;
+                 for (const auto & ray : rays) {
+                     if (objects.boxes[0].hit(ray, RAY_RANGE, record)) {
+                         hitCount++;
+                         checksum += record.t + record.normalVector[0];
+                     }
+                 }
+                 return hitCount;
+             }},
+            {"Transform::hit", "box", 1,
+             [](const KernelObjects & objects) { return objects.transform.transformedBoundingBox; },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 return primitiveHits(objects.transform, rays, checksum);
+             }},
+            //四个子包围盒：标量实现逐个测试，宽节点实现一次测试全部，两者的命中率应相同
+            {"BoundingBox::hit", "scalar", BVHWideNode::WIDTH,
+             [](const KernelObjects & objects) { return BoundingBox(objects.childBoxes[0], objects.childBoxes[3]); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 Uint64 hitCount = 0;
+                 for (const auto & ray : rays) {
+                     for (const auto & box : objects.childBoxes) {
+                         Real t;
+                         if (box.hit(ray, RAY_RANGE, t)) {
+                             hitCount++;
+                             checksum += t;
+                         }
+                     }
+                 }
+                 return hitCount;
+             }},
+            {"BoundingBox::hit", "wide4", BVHWideNode::WIDTH,
+             [](const KernelObjects & objects) { return BoundingBox(objects.childBoxes[0], objects.childBoxes[3]); },
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 Uint64 hitCount = 0;
+                 for (const auto & ray : rays) {
+                     Real tNear[BVHWideNode::WIDTH];
+                     const int mask = objects.wideNode.hit(ray, RAY_RANGE, tNear);
+                     for (Uint32 i = 0; i < BVHWideNode::WIDTH; i++) {
+                         if ((mask & (1 << i)) == 0) continue;
+                         hitCount++;
+                         checksum += tNear[i];
+                     }
+                 }
+                 return hitCount;
+             }},
+            //每条“光线”对应一个像素的颜色写入，批次只决定像素数
+            {"Color3::writeColor", "default", 1, nullptr,
+             [](const KernelObjects & objects, const std::vector<TraversalRay> & rays, double & checksum) {
+                 auto & pixels = const_cast<std::vector<Uint32> &>(objects.pixels);
+                 for (size_t i = 0; i < rays.size(); i++) {
+                     objects.colors[i].writeColor(pixels.data() + i, objects.pixelFormat);
+                 }
+                 checksum += pixels[rays.size() / 2];
+                 return static_cast<Uint64>(rays.size());
+             }}
+    };
+
+    // ====== 光线批次 ======
+
+    /*
+     * 生成以包围盒中心为目标的随机光线批次
+     * 起点均匀分布在半径为ORIGIN_DISTANCE倍半对角线的球面上
+     * isHitHeavy为true时射向包围盒内的均匀随机点；为false时射向中心在垂直于视线方向上偏移2倍半对角线的点，
+     * 此时光线与中心的距离约为1.79倍半对角线，不与包围球相交
+     */
+    std::vector<TraversalRay> generateRays(const BoundingBox & target, bool isHitHeavy, Uint32 rayCount, RandomGenerator & rng) {
+        Point3 center;
+        Vec3 halfDiagonal;
+        for (int axis = 0; axis < 3; axis++) {
+            center[axis] = 0.5 * (target[axis].min + target[axis].max);
+            halfDiagonal[axis] = 0.5 * target[axis].length();
+        }
+        const double radius = halfDiagonal.length();
+
+        std::vector<TraversalRay> ret;
+        ret.reserve(rayCount);
+        for (Uint32 i = 0; i < rayCount; i++) {
+            const double u1 = rng.nextDouble();
+            const double v1 = rng.nextDouble();
+            const Point3 origin = center + Vec3::uniformSphereVector(u1, v1) * (ORIGIN_DISTANCE * radius);
+
+            Point3 to;
+            if (isHitHeavy) {
+                for (int axis = 0; axis < 3; axis++) {
+                    to[axis] = rng.nextDouble(target[axis].min, target[axis].max);
+                }
+            } else {
+                //将随机方向投影到与视线垂直的平面上，投影长度过小时重新采样
+                const Vec3 view = Point3::constructVector(origin, center).unitVector();
+                Vec3 offset;
+                do {
+                    const double u2 = rng.nextDouble();
+                    const double v2 = rng.nextDouble();
+                    const Vec3 random = Vec3::uniformSphereVector(u2, v2);
+                    offset = random - view * Vec3::dot(random, view);
+                } while (offset.length() < 0.1);
+                to = center + offset.unitVector() * (2.0 * radius);
+            }
+            ret.emplace_back(Ray(origin, Point3::constructVector(origin, to).unitVector()));
+        }
+        return ret;
+    }
+
+    //字符串的哈希值，用于从内核名派生光线批次的随机数序列
+    Uint64 nameHash(const char * name) {
+        Uint64 ret = 0;
+        for (const char * p = name; *p != '\0'; p++) {
+            ret = mixBits(ret ^ static_cast<unsigned char>(*p));
+        }
+        return ret;
+    }
+
+    // ====== 计时 ======
+
+    struct MeasureResult {
+        Uint64 testCount;   //最快一轮的测试次数
+        double nsPerTest;   //最快一轮的每次测试耗时
+        double hitRate;     //命中次数与测试次数之比
+    };
+
+    double elapsedNanoseconds(Uint64 startCounter) {
+        return static_cast<double>(SDL_GetPerformanceCounter() - startCounter) * 1e9 / static_cast<double>(SDL_GetPerformanceFrequency());
+    }
+
+    /*
+     * 先运行一遍预热缓存和分支预测器，再分多轮计时，每轮重复整个批次直到达到最短时间，取最快的一轮
+     * 取最快一轮可以排除线程调度和频率变化造成的干扰
+     */
+    MeasureResult measureKernel(const MicroKernel & kernel, const KernelObjects & objects, const std::vector<TraversalRay> & rays,
+                                Uint32 minTime, volatile double & sink) {
+        double checksum = 0.0;
+        const Uint64 hitCount = kernel.function(objects, rays, checksum);
+
+        const double roundTime = minTime * 1e6 / MEASURE_ROUND_COUNT;
+        MeasureResult ret {0, std::numeric_limits<double>::infinity(), 0.0};
+        for (Uint32 round = 0; round < MEASURE_ROUND_COUNT; round++) {
+            Uint64 batchCount = 0;
+            double elapsed;
+            const Uint64 startCounter = SDL_GetPerformanceCounter();
+            do {
+                kernel.function(objects, rays, checksum);
+                batchCount++;
+                elapsed = elapsedNanoseconds(startCounter);
+            } while (elapsed < roundTime);
+
+            const Uint64 testCount = batchCount * rays.size() * kernel.testsPerRay;
+            const double nsPerTest = elapsed / static_cast<double>(testCount);
+            if (nsPerTest < ret.nsPerTest) {
+                ret.testCount = testCount;
+                ret.nsPerTest = nsPerTest;
+            }
+        }
+        ret.hitRate = static_cast<double>(hitCount) / static_cast<double>(rays.size() * kernel.testsPerRay);
+        sink = sink + checksum;
+        return ret;
+    }
+
+    // ====== 命令行和输出 ======
+
+    struct CommandLineOptions {
+        std::vector<std::string> filters;
+        Uint32 rayCount = DEFAULT_RAY_COUNT;
+        Uint32 minTime = DEFAULT_MIN_TIME;
+        std::string outputPath;
+        std::string baselinePath;
+        bool isListOnly = false;
+    };
+
+    bool parseUint32(const char * str, Uint32 & value) {
+        char * end;
+        const unsigned long result = strtoul(str, &end, 10);
+        if (*str == '\0' || *str == '-' || *end != '\0' || result > std::numeric_limits<Uint32>::max()) {
+            return false;
+        }
+        value = static_cast<Uint32>(result);
+        return true;
+    }
+
+    CommandLineOptions parseCommandLine(int argc, char * argv[]) {
+        CommandLineOptions ret;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg(argv[i]);
+            if (arg == "--filter" && i + 1 < argc) {
+                ret.filters.emplace_back(argv[++i]);
+            } else if (arg == "--rays" && i + 1 < argc && parseUint32(argv[i + 1], ret.rayCount) && ret.rayCount > 0) {
+                i++;
+            } else if (arg == "--min-time" && i + 1 < argc && parseUint32(argv[i + 1], ret.minTime) && ret.minTime > 0) {
+                i++;
+            } else if (arg == "--output" && i + 1 < argc) {
+                ret.outputPath = argv[++i];
+            } else if (arg == "--baseline" && i + 1 < argc) {
+                ret.baselinePath = argv[++i];
+            } else if (arg == "--list") {
+                ret.isListOnly = true;
+            } else {
+                SDL_Log("Usage: %s [--filter name]... [--rays N] [--min-time ms] [--output file.csv] [--baseline file.csv] [--list]", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        return ret;
+    }
+
+    bool isKernelSelected(const MicroKernel & kernel, const std::vector<std::string> & filters) {
+        if (filters.empty()) {
+            return true;
+        }
+        const std::string name = std::string(kernel.name) + "/" + kernel.variant;
+        for (const auto & filter : filters) {
+            if (name.find(filter) != std::string::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string resultKey(const std::string & kernel, const std::string & variant, const std::string & batch) {
+        return kernel + "," + variant + "," + batch;
+    }
+
+    /*
+     * 读取基准CSV，返回kernel,variant,case到ns_per_test的映射
+     * 只读取前5列（键和测试次数、耗时），可以直接使用本程序带或不带基准列的输出
+     */
+    std::vector<std::pair<std::string, double>> readBaseline(const std::string & path) {
+        FILE * file = fopen(path.c_str(), "r");
+        if (file == nullptr) {
+            throw std::runtime_error("Failed to open baseline file: " + path);
+        }
+        std::vector<std::pair<std::string, double>> ret;
+        char line[512];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            std::vector<std::string> fields;
+            std::string field;
+            for (const char * p = line; *p != '\0' && *p != '\n' && *p != '\r'; p++) {
+                if (*p == ',') {
+                    fields.push_back(field);
+                    field.clear();
+                } else {
+                    field.push_back(*p);
+                }
+            }
+            fields.push_back(field);
+            if (fields.size() < 5 || fields[0] == "kernel") {
+                continue;
+            }
+            ret.emplace_back(resultKey(fields[0], fields[1], fields[2]), strtod(fields[4].c_str(), nullptr));
+        }
+        fclose(file);
+        return ret;
+    }
+
+    void releaseSDLResourcesImpl() {
+        releaseSDLResource(SDL_Quit(), "Quit");
+    }
+}
+
+int main(int argc, char * argv[]) {
+    const CommandLineOptions options = parseCommandLine(argc, argv);
+    if (options.isListOnly) {
+        for (const auto & kernel : KERNELS) {
+            printf("%s/%s\n", kernel.name, kernel.variant);
+        }
+        return 0;
+    }
+
+    registerReleaseSDLResources(releaseSDLResourcesImpl);
+    sdlCheckErrorInt(SDL_Init(0), "Init", EXIT_PROGRAM);
+
+    const auto baseline = options.baselinePath.empty() ?
+            std::vector<std::pair<std::string, double>>() : readBaseline(options.baselinePath);
+
+    FILE * file = options.outputPath.empty() ? stdout : fopen(options.outputPath.c_str(), "w");
+    if (file == nullptr) {
+        SDL_Log("Failed to open output file: %s", options.outputPath.c_str());
+        releaseSDLResourcesImpl();
+        return EXIT_FAILURE;
+    }
+
+    //准备测试对象，颜色写入的输入与光线批次使用同一个种子
+    KernelObjects objects;
+    RandomGenerator rng(MICRO_BENCHMARK_SEED);
+    objects.colors.reserve(options.rayCount);
+    for (Uint32 i = 0; i < options.rayCount; i++) {
+        objects.colors.push_back(Color3::randomColor(rng, 0.0, 1.2));
+    }
+    objects.pixels.resize(options.rayCount);
+    objects.pixelFormat = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+    sdlCheckErrorPtr(objects.pixelFormat, "AllocFormat", EXIT_PROGRAM);
+
+    fprintf(file, "kernel,variant,case,tests,ns_per_test,hit_rate%s\n", baseline.empty() ? "" : ",baseline_ns_per_test,speedup");
+    volatile double sink = 0.0;
+    for (const auto & kernel : KERNELS) {
+        if (!isKernelSelected(kernel, options.filters)) {
+            continue;
+        }
+        for (int batch = 0; batch < (kernel.target == nullptr ? 1 : 2); batch++) {
+            const bool isHitHeavy = batch == 0;
+            const char * batchName = kernel.target == nullptr ? "all" : (isHitHeavy ? "hit" : "miss");
+
+            //光线批次由内核名和批次决定，同一内核的不同实现、不同的运行和编译选项都使用相同的光线
+            RandomGenerator batchRng(MICRO_BENCHMARK_SEED, nameHash(kernel.name) + batch);
+            const std::vector<TraversalRay> rays = kernel.target == nullptr ?
+                    std::vector<TraversalRay>(options.rayCount, TraversalRay(Ray())) :
+                    generateRays(kernel.target(objects), isHitHeavy, options.rayCount, batchRng);
+
+            const MeasureResult result = measureKernel(kernel, objects, rays, options.minTime, sink);
+            fprintf(file, "%s,%s,%s,%llu,%.4lf,%.4lf", kernel.name, kernel.variant, batchName,
+                    static_cast<unsigned long long>(result.testCount), result.nsPerTest, result.hitRate);
+            if (!baseline.empty()) {
+                const std::string key = resultKey(kernel.name, kernel.variant, batchName);
+                const auto iter = std::find_if(baseline.begin(), baseline.end(),
+                                               [&key](const std::pair<std::string, double> & item) { return item.first == key; });
+                if (iter != baseline.end() && iter->second > 0.0) {
+                    fprintf(file, ",%.4lf,%.3lf", iter->second, iter->second / result.nsPerTest);
+                } else {
+                    fprintf(file, ",,");
+                }
+            }
+            fprintf(file, "\n");
+            fflush(file);
+        }
+    }
+    SDL_Log("Micro benchmark checksum: %lf", static_cast<double>(sink));
+
+    SDL_FreeFormat(objects.pixelFormat);
+    if (file != stdout) {
+        fclose(file);
+        SDL_Log("Micro benchmark results saved: %s", options.outputPath.c_str());
+    }
+    releaseSDLResourcesImpl();
+    return 0;
+}
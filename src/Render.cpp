@@ -2,88 +2,167 @@
 
 using namespace std;
 
+namespace {
+    using namespace renderer;
+
+    /*
+     * 采样器的维度布局：相机光线占用前CAMERA_DIMENSION_COUNT个维度（像素内位置2维、镜头2维、快门时间1维）
+     * 之后每次反射占用BOUNCE_DIMENSION_COUNT个维度（光源选择1维、光源上的点2维、方向采样的PDF选择1维、方向2维、俄罗斯轮盘赌1维，余1维）
+     * 同一用途在所有采样中使用相同的维度，低差异序列才能在该维度上分层
+     */
+    constexpr Uint32 CAMERA_DIMENSION_COUNT = 5;
+    constexpr Uint32 BOUNCE_DIMENSION_COUNT = 8;
+
+    //多重重要性采样的幂启发式权重（指数为2），pdf为当前采样策略的概率密度，otherPDF为另一个采样策略的概率密度
+    inline Real powerHeuristic(Real pdf, Real otherPDF) {
+        const Real pdfSquare = pdf * pdf;
+        const Real sum = pdfSquare + otherPDF * otherPDF;
+        return sum > 0.0 ? pdfSquare / sum : 0.0;
+    }
+}
+
 namespace renderer {
     /*
      * 像素渲染函数：根据每个像素的光线对象和场景物体列表进行光线计算
      * 物体数量信息包含在BVH树的节点中，求交函数通过判断叶子节点终止递归
+     * 返回光路的颜色以及第一个碰撞点的降噪数据，不写入任何共享状态
      */
-    Color3 rayColor(Camera & cam, const Ray & ray, size_t sampleIndex,
-                    const BVHTree::BVHTreeNode * tree, const std::pair<PrimitiveType, size_t> * indexArray,
+    PathSample rayColor(const Camera & cam, Sampler & sampler, const Ray & ray,
+                    const BVHTree::WideNode * tree, const std::pair<PrimitiveType, size_t> * indexArray,
                     const Sphere * spheres,
                     const Triangle * triangles,
                     const Parallelogram * parallelograms,
                     const Transform * transforms,
                     const Box * boxes,
+                    const TriangleMesh * meshes,
                     const Rough * roughMaterials, const Metal * metalMaterials,
                     const DiffuseLight * lightMaterials, const Dielectric * dielectricMaterials,
-                    const Sphere * hittablePDFSphere, size_t hittablePDFSphereCount,
-                    const Parallelogram * hittablePDFParallelogram, size_t hittablePDFParallelogramCount)
+                    const LightSampler & lightSampler,
+                    const HittablePDF * guidePDFs, size_t guidePDFCount,
+                    const Sphere * hittablePDFSphere, const Parallelogram * hittablePDFParallelogram)
     {
         HitRecord record;
         Ray currentRay(ray);
-        Color3 result(1.0, 1.0, 1.0);
+        Color3 result(1.0, 1.0, 1.0);      //光路的吞吐量
+        PathSample sample;                 //降噪数据在第一次碰撞时写入，光路没有击中非光源物体时为0
+        Color3 & radiance = sample.color;  //光路上已经收集到的光照
+
+        /*
+         * 粗糙表面使用两种采样策略估计直接光照，按幂启发式合并（多重重要性采样）
+         *   光源采样：向随机选择的光源上的随机点发射阴影光线，阴影光线直接击中光源时累加其光照
+         *   方向采样：按MixturePDF生成下一段光线，下一段光线击中光源时累加其光照
+         * 同一方向在两种策略下的权重之和为1，结果仍然无偏
+         * 记录上一次粗糙表面反射的碰撞点和方向采样的概率密度，用于计算方向采样击中光源时的权重
+         * 相机光线和镜面反射（金属、玻璃）之后击中光源，以及击中不在光源采样器中的发光物体时，没有对应的光源采样，权重为1
+         */
+        const size_t lightCount = lightSampler.lightCount();
+        traversalStatisticsAdd(pathCount, 1);
+        Point3 lastRoughHitPoint;
+        bool isLastBounceRough = false;
+        Real lastBSDFPDFValue = 0.0;
 
         for (size_t currentIterateDepth = 0; currentIterateDepth < cam.rayTraceDepth; currentIterateDepth++) {
-            if (BVHTree::hit(tree, indexArray, spheres, triangles, parallelograms, transforms, boxes,
-                             currentRay, Range(0.001, INFINITY), record)) {
+            sampler.startDimensions(CAMERA_DIMENSION_COUNT + static_cast<Uint32>(currentIterateDepth) * BOUNCE_DIMENSION_COUNT, BOUNCE_DIMENSION_COUNT);
+            sample.rayCount++;
+            traversalStatisticsAdd(bounceCount, 1);
+            if (BVHTree::hit(tree, indexArray, spheres, triangles, parallelograms, transforms, boxes, meshes,
+                             currentRay, Range(0.0, INFINITY), record)) {
                 Ray out;
                 Color3 attenuation;
 
                 //光源
                 if (record.materialType == MaterialType::DIFFUSE_LIGHT) {
                     //光源是光路的终点，需要综合之前的颜色，并结束光路
-                    return result * lightMaterials[record.materialIndex].emitted(currentRay, record);
+                    Real weight = 1.0;
+                    const int lightIndex = isLastBounceRough ? lightSampler.findLight(record) : -1;
+                    if (lightIndex >= 0) {
+                        weight = powerHeuristic(lastBSDFPDFValue, lightSampler.value(static_cast<size_t>(lightIndex), lastRoughHitPoint,
+                                                                                     hittablePDFSphere, hittablePDFParallelogram, currentRay.direction));
+                    }
+                    radiance.addProduct(result * lightMaterials[record.materialIndex].emitted(currentRay, record), weight);
+                    return sample;
+                }
+
+                //记录降噪器信息：第一个碰撞点的法向量（相机空间），反照率在散射后写入
+                if (currentIterateDepth == 0) {
+                    sample.normal = cam.base.transformToLocal(record.normalVector);
                 }
 
                 //非光源，根据材质类型调用对应的散射函数
+                isLastBounceRough = false;
                 switch (record.materialType) {
                     case MaterialType::ROUGH: {
+                        const Rough & rough = roughMaterials[record.materialIndex];
+
                         //CosinePDF用于材质表面采样
                         const CosinePDF cosinePDF[] = {
                                 CosinePDF(record.normalVector)
                         };
 
-                        //将HittablePDF和CosinePDF组合进MixturePDF
-                        HittablePDF hittablePDF[32] {};
-                        size_t hittablePDFCount = 0;
-                        for (size_t i = 0; i < hittablePDFSphereCount; i++) {
-                            hittablePDF[hittablePDFCount++] = HittablePDF(PrimitiveType::SPHERE, i, record.hitPoint);
-                        }
-                        for (size_t i = 0; i < hittablePDFParallelogramCount; i++) {
-                            hittablePDF[hittablePDFCount++] = HittablePDF(PrimitiveType::PARALLELOGRAM, i, record.hitPoint);
+                        //光源由光源采样器采样，其他直接采样物体（如玻璃球）的HittablePDF和CosinePDF组合进MixturePDF，从碰撞点向物体采样
+                        const MixturePDF pdf(cosinePDF, guidePDFs, 1, guidePDFCount, record.hitPoint);
+                        const Color3 BRDFvalue = rough.evalBRDF(currentRay, record);
+
+                        //光源采样：阴影光线击中的第一个物体是被选中的光源时累加光照，被遮挡时没有贡献
+                        if (lightCount > 0) {
+                            const size_t lightIndex = lightSampler.sample(sampler);
+                            const Ray shadowRay = Ray::spawn(currentRay, record, lightSampler.generate(lightIndex, record.hitPoint, hittablePDFSphere,
+                                                                                                      hittablePDFParallelogram, sampler).unitVector());
+                            const Real lightValue = lightSampler.value(lightIndex, record.hitPoint, hittablePDFSphere,
+                                                                         hittablePDFParallelogram, shadowRay.direction);
+                            const Real cosTheta = rough.cosTheta(shadowRay, record);
+
+                            //只有朝向表面正面且PDF有效的阴影光线才需要求交
+                            const bool isShadowRayTraced = cosTheta > 0.0 && lightValue > 0.0 && !isinf(lightValue);
+                            if (isShadowRayTraced) {
+                                sample.rayCount++;
+                                traversalStatisticsAdd(shadowRayCount, 1);
+                            }
+
+                            HitRecord lightRecord;
+                            if (isShadowRayTraced &&
+                                BVHTree::hit(tree, indexArray, spheres, triangles, parallelograms, transforms, boxes, meshes,
+                                             shadowRay, Range(0.0, INFINITY), lightRecord) &&
+                                lightRecord.materialType == MaterialType::DIFFUSE_LIGHT &&
+                                lightSampler.findLight(lightRecord) == static_cast<int>(lightIndex))
+                            {
+                                const Real BSDFPDFValue = pdf.value(hittablePDFSphere, hittablePDFParallelogram, shadowRay.direction);
+                                const Real weight = powerHeuristic(lightValue, BSDFPDFValue);
+                                radiance.addProduct(result * BRDFvalue * lightMaterials[lightRecord.materialIndex].emitted(shadowRay, lightRecord),
+                                                    cosTheta * weight / lightValue);
+                            }
                         }
 
-                        const MixturePDF pdf(cosinePDF, hittablePDF,
-                                             1, hittablePDFSphereCount + hittablePDFParallelogramCount);
-
-                        //使用MixturePDF生成一个新的光线方向
-                        out = Ray(record.hitPoint, pdf.generate(hittablePDFSphere, hittablePDFParallelogram), ray.time);
-                        const double pdfValue = pdf.value(hittablePDFSphere, hittablePDFParallelogram, out.direction);
+                        //方向采样：使用MixturePDF生成一个新的光线方向
+                        out = Ray::spawn(currentRay, record, pdf.generate(hittablePDFSphere, hittablePDFParallelogram, sampler));
+                        const Real pdfValue = pdf.value(hittablePDFSphere, hittablePDFParallelogram, out.direction);
 
                         //pdfValue有效性检查
                         if (isnan(pdfValue) || isinf(pdfValue) || floatValueNearZero(pdfValue)) {
-                            return Color3(); //此处return result会使得画面严重偏白，PDF无效时，整条光路结果为黑色
+                            return sample; //此处return result会使得画面严重偏白，PDF无效时结束光路，只保留已经收集到的光照
                         }
 
-                        const Color3 BRDFvalue = roughMaterials[record.materialIndex].evalBRDF(currentRay, record);
-                        const double cosTheta = roughMaterials[record.materialIndex].cosTheta(out, record);
+                        const Real cosTheta = rough.cosTheta(out, record);
                         result *= BRDFvalue * cosTheta / pdfValue;
 
+                        isLastBounceRough = true;
+                        lastRoughHitPoint = record.hitPoint;
+                        lastBSDFPDFValue = pdfValue;
                         attenuation = BRDFvalue * PI;
                         currentRay = out;
                         break;
                     }
                     case MaterialType::METAL: {
-                        if (metalMaterials[record.materialIndex].scatter(currentRay, record, attenuation, out)) {
+                        if (metalMaterials[record.materialIndex].scatter(currentRay, record, attenuation, out, sampler)) {
                             result *= attenuation;
                             currentRay = out;
                         } else {
-                            return result;
+                            return sample; //反射方向位于表面以下，光线被吸收
                         }
                         break;
                     }
                     case MaterialType::DIELECTRIC: {
-                        dielectricMaterials[record.materialIndex].scatter(currentRay, record, attenuation, out);
+                        dielectricMaterials[record.materialIndex].scatter(currentRay, record, attenuation, out, sampler);
                         result *= attenuation;
                         currentRay = out;
                         break;
@@ -91,44 +170,57 @@ namespace renderer {
                     default:;
                 }
 
-                //记录降噪器信息
-                if (!cam.isRecordList[sampleIndex]) {
-                    cam.albedoList[sampleIndex] = attenuation;
-                    cam.normalList[sampleIndex] = cam.base.transformToLocal(record.normalVector);
-                    cam.isRecordList[sampleIndex] = true;
+                if (currentIterateDepth == 0) {
+                    sample.albedo = attenuation;
+                }
+
+                /*
+                 * 俄罗斯轮盘赌：反射次数达到russianRouletteDepth后，吞吐量小于1的光路以吞吐量为存活概率继续追踪
+                 * 存活的光路的吞吐量除以存活概率，期望不变，结果仍然无偏
+                 * 吞吐量低的光路对结果贡献很小，提前终止可以减少深层反射的开销
+                 */
+                if (currentIterateDepth + 1 >= cam.russianRouletteDepth) {
+                    const Real survivalProbability = std::min<Real>(result.maxComponent(), 1.0);
+                    if (survivalProbability < 1.0) {
+                        if (sampler.nextDouble() >= survivalProbability) {
+                            return sample;
+                        }
+                        result /= survivalProbability;
+                    }
                 }
             } else {
-                result *= cam.backgroundColor; //没有发生碰撞，将背景光颜色作为光源乘入结果并结束追踪循环
+                radiance.addProduct(result, cam.backgroundColor); //没有发生碰撞，将背景光颜色作为光源乘入结果并结束追踪循环
                 break;
             }
         }
-        return result;
+        //达到最大追踪深度时光路没有到达光源，没有新的光照
+        return sample;
     }
 
     /*
      * 光线构造函数：根据相机对象和线程下标构造光线
      */
-    Ray constructRay(const Camera & cam, const Point3 & samplePoint) {
+    Ray constructRay(const Camera & cam, const Point3 & samplePoint, Sampler & sampler) {
         //离焦采样：在离焦半径内随机选取一个点，以这个点发射光线
         Point3 rayOrigin = cam.cameraCenter;
         if (cam.focusDiskRadius > 0.0) {
-            const Vec3 defocusVector = Vec3::randomPlaneVector(cam.focusDiskRadius);
+            const Vec3 defocusVector = Vec3::randomPlaneVector(cam.focusDiskRadius, sampler);
             //使用视口方向向量定位采样点
             rayOrigin = cam.cameraCenter + defocusVector[0] * cam.cameraU + defocusVector[1] * cam.cameraV;
         }
 
         //在快门开启时段内随机找一个时刻发射光线
         const Vec3 rayDirection = Point3::constructVector(rayOrigin, samplePoint).unitVector();
-        return Ray(rayOrigin, rayDirection, randomDouble(cam.shutterRange.min, cam.shutterRange.max));
+        return Ray(rayOrigin, rayDirection, sampler.nextDouble(cam.shutterRange.min, cam.shutterRange.max));
     }
 
     /*
      * 主渲染函数
      *
-     * 需要传入场景信息：相机对象和物体列表，窗口信息
-     *     以及输出信息：用于写入颜色数据的指针
+     * 需要传入场景信息：相机对象和物体列表
+     *     以及输出信息：用于写入渲染结果的浮点帧缓冲区，预览窗口为nullptr时不显示渲染过程（无窗口批处理渲染）
      */
-    Uint32 render(Camera & cam, SDL_Window * window, SDL_Surface * surface,
+    Uint32 render(Camera & cam, FrameBuffer & frameBuffer, Viewer * viewer,
                   const Rough * roughMaterials, const Metal * metalMaterials,
                   const DiffuseLight * lightMaterials, const Dielectric * dielectricMaterials,
                   const Sphere * spheres, Uint32 sphereCount,
@@ -136,12 +228,14 @@ namespace renderer {
                   const Parallelogram * parallelograms, Uint32 parallelogramCount,
                   const Transform * transforms, Uint32 transformCount,
                   const Box * boxes, Uint32 boxCount,
+                  const TriangleMesh * meshes, Uint32 meshCount,
                   const Sphere * hittablePDFSphere, size_t hittablePDFSphereCount,
-                  const Parallelogram * hittablePDFParallelogram, size_t hittablePDFParallelogramCount)
+                  const Parallelogram * hittablePDFParallelogram, size_t hittablePDFParallelogramCount,
+                  RenderStatistics * statistics)
     {
-
-        auto pixels = static_cast<Uint32 *>(surface->pixels);
-        auto format = surface->format;
+        if (frameBuffer.width != cam.windowWidth || frameBuffer.height != cam.windowHeight) {
+            throw std::runtime_error("Frame buffer size does not match camera!");
+        }
 
         //构建BVH
         auto sphereVector = vector<Sphere>(spheres, spheres + sphereCount);
@@ -149,105 +243,349 @@ namespace renderer {
         auto parallelogramVector = vector<Parallelogram>(parallelograms, parallelograms + parallelogramCount);
         auto transformVector = vector<Transform>(transforms, transforms + transformCount);
         auto boxVector = vector<Box>(boxes, boxes + boxCount);
+        auto meshVector = vector<TriangleMesh>(meshes, meshes + meshCount);
 
         //先利用vector的返回值传递接收数组，再转换为指针
-        //在此处构造包含所有物体的HittableList的BVH
-        const auto ret = BVHTree::constructBVHTree(sphereVector, triangleVector, parallelogramVector, transformVector, boxVector);
+        //在此处构造包含所有物体的HittableList的BVH，构建时间和渲染时间分别统计
+        BVHBuildOptions buildOptions;
+        buildOptions.threadCount = cam.threadCount;
+        const Uint32 buildStartTick = SDL_GetTicks();
+        const auto ret = BVHTree::constructBVHTree(sphereVector, triangleVector, parallelogramVector, transformVector, boxVector, meshVector, buildOptions);
+        SDL_Log("BVH build completed. Primitives: %zu, Nodes: %zu, Time: %u ms",
+                ret.second.size(), ret.first.size(), SDL_GetTicks() - buildStartTick);
+
+        //折叠为四叉宽BVH用于遍历，一次SIMD相交测试检查一个节点的所有子节点
+        const auto wideTree = BVHTree::constructWideTree(ret.first);
+        const Uint32 bvhBuildTime = SDL_GetTicks() - buildStartTick; //包括折叠为宽BVH的时间
+        SDL_Log("Wide BVH nodes: %zu, %zu bytes", wideTree.size(), wideTree.size() * sizeof(BVHTree::WideNode));
 
         //获取原始指针，用于在GPU函数间传递
-        const BVHTree::BVHTreeNode * tree = ret.first.data();
+        const BVHTree::WideNode * tree = wideTree.data();
         const std::pair<PrimitiveType, size_t> * indexArray = ret.second.data();
 
-#define REFRESH_ON_RENDER
-#ifdef REFRESH_ON_RENDER
-        const Uint32 refreshRate = 1;
-        Uint32 lastRate = 0;
+        //直接采样物体中的光源构建光源采样器，其他物体在方向采样时与CosinePDF混合
+        const LightSampler lightSampler(hittablePDFSphere, hittablePDFSphereCount,
+                                        hittablePDFParallelogram, hittablePDFParallelogramCount, lightMaterials);
+        //非光源物体的HittablePDF只包含物体索引，渲染开始前构造一次，所有线程共享
+        vector<HittablePDF> guidePDFVector;
+        for (size_t i = 0; i < hittablePDFSphereCount; i++) {
+            if (hittablePDFSphere[i].materialType != MaterialType::DIFFUSE_LIGHT) {
+                guidePDFVector.emplace_back(PrimitiveType::SPHERE, i);
+            }
+        }
+        for (size_t i = 0; i < hittablePDFParallelogramCount; i++) {
+            if (hittablePDFParallelogram[i].getMaterialType() != MaterialType::DIFFUSE_LIGHT) {
+                guidePDFVector.emplace_back(PrimitiveType::PARALLELOGRAM, i);
+            }
+        }
+        const HittablePDF * guidePDFs = guidePDFVector.data();
+        const size_t guidePDFCount = guidePDFVector.size();
+        SDL_Log("Light sampler: %zu lights, %zu guide objects", lightSampler.lightCount(), guidePDFCount);
+
+        //将帧缓冲区划分为图块，每个图块作为一个任务提交到工作窃取线程池
+        //不同图块的像素互不重叠，各线程写入帧缓冲区时无需加锁
+        const Uint32 tileSize = cam.tileSize > 0 ? cam.tileSize : 32;
+        const Uint32 tileCountX = (cam.windowWidth + tileSize - 1) / tileSize;
+        const Uint32 tileCountY = (cam.windowHeight + tileSize - 1) / tileSize;
+        const Uint32 tileCount = tileCountX * tileCountY;
+
+        //图块的像素范围：[rowStart, rowEnd) x [colStart, colEnd)
+        auto tileRegion = [&](Uint32 tileIndex, Uint32 & rowStart, Uint32 & rowEnd, Uint32 & colStart, Uint32 & colEnd) {
+            rowStart = (tileIndex / tileCountX) * tileSize;
+            colStart = (tileIndex % tileCountX) * tileSize;
+            rowEnd = std::min(rowStart + tileSize, cam.windowHeight);
+            colEnd = std::min(colStart + tileSize, cam.windowWidth);
+        };
+
+        /*
+         * 渐进式渲染：每一轮为每个尚未完成的像素增加最多samplesPerPass个采样，结果累加到帧缓冲区
+         * 采样点使用sqrtSampleCount x sqrtSampleCount的分层抖动，像素的第k个采样位于第(k * strataStep) % strataCount个层
+         * strataStep与层数互质，多轮渲染时每一轮的采样均匀分布在像素内，提前停止时不会只覆盖像素的一部分
+         *
+         * 自适应采样：像素达到最小采样数后，显示空间的误差低于阈值即视为收敛，不再分配采样
+         * 图块内所有像素都完成后，后续的轮次不再提交该图块
+         */
+        const Uint32 strataCount = static_cast<Uint32>(cam.sqrtSampleCount * cam.sqrtSampleCount);
+        const bool isAdaptive = cam.adaptiveThreshold > 0.0;
+        const Uint32 minSampleCount = std::max(cam.adaptiveMinSampleCount, 2u);
+        const Uint32 maxSampleCount = isAdaptive ?
+                std::max(cam.adaptiveMaxSampleCount > 0 ? cam.adaptiveMaxSampleCount : strataCount, minSampleCount) : strataCount;
+        const Uint32 samplesPerPass = std::min(cam.samplesPerPass > 0 ? cam.samplesPerPass : (isAdaptive ? minSampleCount : maxSampleCount),
+                                               maxSampleCount);
+        Uint32 strataStep = 1;
+        if (samplesPerPass < maxSampleCount) {
+            auto greatestCommonDivisor = [](Uint32 a, Uint32 b) {
+                while (b != 0) {
+                    const Uint32 remainder = a % b;
+                    a = b;
+                    b = remainder;
+                }
+                return a;
+            };
+            strataStep = static_cast<Uint32>(strataCount * 0.618) + 1;
+            while (greatestCommonDivisor(strataStep, strataCount) != 1) strataStep++;
+        }
+
+        //像素是否还需要继续采样
+        auto isPixelActive = [&](Uint32 row, Uint32 col) {
+            const Uint32 sampleCount = frameBuffer.sampleCounts[static_cast<size_t>(row) * frameBuffer.width + col];
+            if (sampleCount >= maxSampleCount) {
+                return false;
+            }
+            return !isAdaptive || sampleCount < minSampleCount || frameBuffer.displayError(row, col) >= cam.adaptiveThreshold;
+        };
+
+        ThreadPool pool(cam.threadCount);
+        std::atomic<Uint32> finishedTileCount(0);
+        std::atomic<Uint64> activePixelCount(0);
+
+        //光线数统计：每个图块先在本地累加，图块完成时再合并，避免每条光线都进行原子操作
+        std::atomic<Uint64> primaryRayCount(0);
+        std::atomic<Uint64> totalRayCount(0);
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+        TraversalCounters traversalTotal {};
+        std::mutex traversalMutex;
 #endif
+        Uint32 denoiseTime = 0;
+        auto denoise = [&]() {
+            const Uint32 denoiseStartTick = SDL_GetTicks();
+            cam.denoiser.denoise(frameBuffer);
+            denoiseTime += SDL_GetTicks() - denoiseStartTick;
+        };
+
+        //预览降噪的结果，只用于显示
+        std::vector<float> previewColor;
+
+        //每个图块是否还有需要采样的像素，由渲染该图块的线程在每轮结束时写入
+        std::vector<Uint8> isTileActive(tileCount, 1);
+        std::vector<Uint32> activeTiles;
+
+        //已完成但尚未显示的图块，仅在有预览窗口时记录，主线程取出后写入窗口，不读取正在渲染的图块
+        std::mutex finishedTileMutex;
+        std::vector<Uint32> finishedTiles;
+        std::vector<Uint32> displayTiles;
+        auto displayFinishedTiles = [&]() {
+            displayTiles.clear();
+            {
+                std::lock_guard<std::mutex> lock(finishedTileMutex);
+                displayTiles.swap(finishedTiles);
+            }
+            for (const Uint32 tileIndex : displayTiles) {
+                Uint32 rowStart, rowEnd, colStart, colEnd;
+                tileRegion(tileIndex, rowStart, rowEnd, colStart, colEnd);
+                viewer->writeRegion(frameBuffer, rowStart, rowEnd, colStart, colEnd);
+            }
+            if (!displayTiles.empty()) {
+                viewer->update();
+            }
+        };
 
         //分配线程，由GPU线程执行主渲染逻辑
+        frameBuffer.clearAccumulation();
         const Uint32 startTick = SDL_GetTicks();
-        for (Uint32 i = 0; i < cam.windowHeight; i++) {
-            for (Uint32 j = 0; j < cam.windowWidth; j++) {
-                SDL_Event event;
-                while (SDL_PollEvent(&event)) {
-                    if (event.type == SDL_QUIT) { exit(1); }
+        Uint32 lastRate = 0;
+        Uint32 passIndex = 0;
+        for (; ; passIndex++) {
+            activeTiles.clear();
+            for (Uint32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+                if (isTileActive[tileIndex]) {
+                    activeTiles.push_back(tileIndex);
                 }
+            }
+            if (activeTiles.empty()) {
+                break;
+            }
+
+            //达到时间上限时不再开始新的一轮，使用已累加的采样作为最终结果
+            if (passIndex > 0 && cam.timeLimit > 0 && SDL_GetTicks() - startTick >= cam.timeLimit) {
+                SDL_Log("Time limit reached after %u passes", passIndex);
+                break;
+            }
 
-                Color3 result;
-                Color3 albedo;
-                Vec3 normal;
-                fill(cam.isRecordList.begin(), cam.isRecordList.end(), false);
-
-                //抗锯齿采样
-#define JITTERING
-#ifndef JITTERING
-                for (size_t k = 0; k < cam.sampleCount; k++) {
-                    //构造光线
-                    const Point3 samplePoint =
-                            cam.pixelOrigin + (i + randomDouble(-cam.sampleRange, cam.sampleRange)) * cam.viewPortPixelDy
-                            + (j + randomDouble(-cam.sampleRange, cam.sampleRange)) * cam.viewPortPixelDx;
-                    const Ray ray = constructRay(cam, samplePoint);
-
-                    //进行像素独立的计算
-                    result += rayColor(cam.backgroundColor, ray, cam.rayTraceDepth, tree, indexArray,
-                                       spheres, triangles, parallelograms, transforms,
-                                       roughMaterials, metalMaterials, lightMaterials);
+            //定期降噪用于预览，结果写入单独的缓冲区：自适应采样跳过的像素不再重新计算平均颜色，帧缓冲区中的颜色不能被降噪结果覆盖
+            if (viewer != nullptr && passIndex > 0 && cam.denoisePassInterval > 0 && passIndex % cam.denoisePassInterval == 0) {
+                const Uint32 denoiseStartTick = SDL_GetTicks();
+                const bool isDenoised = cam.denoiser.denoise(frameBuffer, previewColor);
+                denoiseTime += SDL_GetTicks() - denoiseStartTick;
+                //降噪失败时previewColor可能为空或为之前一轮的结果，改为显示未降噪的颜色
+                if (isDenoised) {
+                    viewer->writeFrame(frameBuffer, previewColor);
+                } else {
+                    viewer->writeFrame(frameBuffer);
                 }
-#else
-
-                for (size_t sampleI = 0; sampleI < cam.sqrtSampleCount; sampleI++) {
-                    for (size_t sampleJ = 0; sampleJ < cam.sqrtSampleCount; sampleJ++) {
-                        const double offsetX = ((sampleJ + randomDouble()) * cam.reciprocalSqrtSampleCount) - 0.5;
-                        const double offsetY = ((sampleI + randomDouble()) * cam.reciprocalSqrtSampleCount) - 0.5;
-                        const Point3 samplePoint =
-                                cam.pixelOrigin + ((j + offsetX) * cam.viewPortPixelDx) + ((i + offsetY) * cam.viewPortPixelDy);
-
-                        //构造光线
-                        const Ray ray = constructRay(cam, samplePoint);
-
-                        //发射光线
-                        const size_t sampleIndex = sampleI * cam.sqrtSampleCount + sampleJ;
-                        result += rayColor(cam, ray, sampleIndex, tree, indexArray,
-                                           spheres, triangles, parallelograms, transforms, boxes,
-                                           roughMaterials, metalMaterials, lightMaterials, dielectricMaterials,
-                                           hittablePDFSphere, hittablePDFSphereCount,
-                                           hittablePDFParallelogram, hittablePDFParallelogramCount);
-
-                        //累加当前采样点的降噪数据
-                        albedo += cam.albedoList[sampleIndex];
-                        normal += cam.normalList[sampleIndex];
+                viewer->update();
+            }
+
+            finishedTileCount = 0;
+            activePixelCount = 0;
+            for (const Uint32 tileIndex : activeTiles) {
+                pool.submit([&, tileIndex, passIndex](size_t) {
+                    Uint32 rowStart, rowEnd, colStart, colEnd;
+                    tileRegion(tileIndex, rowStart, rowEnd, colStart, colEnd);
+
+                    Uint64 tileActivePixelCount = 0;
+                    Uint64 tilePrimaryRayCount = 0;
+                    Uint64 tileRayCount = 0;
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+                    TraversalCounters tileTraversal {};
+#endif
+                    for (Uint32 i = rowStart; i < rowEnd; i++) {
+                        for (Uint32 j = colStart; j < colEnd; j++) {
+                            if (!isPixelActive(i, j)) {
+                                continue;
+                            }
+                            const Uint32 firstSample = frameBuffer.sampleCounts[static_cast<size_t>(i) * frameBuffer.width + j];
+                            const Uint32 passSampleCount = std::min(samplesPerPass, maxSampleCount - firstSample);
+
+                            PixelSampleSum samples;
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+                            const TraversalCounters pixelTraversalStart = threadTraversalCounters();
+#endif
+
+                            //每个像素的每一轮使用独立的随机数序列，结果与图块的执行线程和顺序无关
+                            //Sobol序列的扰乱种子在所有轮次中相同，多轮渲染时继续使用同一序列的后续采样
+                            const Uint64 pixelID = static_cast<Uint64>(i) * cam.windowWidth + j;
+                            Sampler sampler(cam.samplerType, mixBits(cam.seed ^ mixBits(pixelID)),
+                                            RandomGenerator(mixBits(cam.seed ^ mixBits(pixelID) ^ mixBits(passIndex)), pixelID));
+
+                            //抗锯齿采样
+                            for (size_t sampleIndex = 0; sampleIndex < passSampleCount; sampleIndex++) {
+                                sampler.startSample(firstSample + static_cast<Uint32>(sampleIndex));
+                                sampler.startDimensions(0, CAMERA_DIMENSION_COUNT);
+
+                                //Sobol序列的前两个维度本身是分层的，直接作为像素内的位置，独立随机数在分层网格的一个层内抖动
+                                double offsetX, offsetY;
+                                sampler.next2D(offsetX, offsetY);
+                                if (cam.samplerType == SamplerType::SOBOL) {
+                                    offsetX -= 0.5;
+                                    offsetY -= 0.5;
+                                } else {
+                                    const size_t stratum = (static_cast<size_t>(firstSample) + sampleIndex) * strataStep % strataCount;
+                                    const size_t sampleI = stratum / cam.sqrtSampleCount;
+                                    const size_t sampleJ = stratum % cam.sqrtSampleCount;
+                                    offsetX = ((sampleJ + offsetX) * cam.reciprocalSqrtSampleCount) - 0.5;
+                                    offsetY = ((sampleI + offsetY) * cam.reciprocalSqrtSampleCount) - 0.5;
+                                }
+                                const Point3 samplePoint =
+                                        cam.pixelOrigin + ((j + offsetX) * cam.viewPortPixelDx) + ((i + offsetY) * cam.viewPortPixelDy);
+
+                                //构造光线
+                                const Ray ray = constructRay(cam, samplePoint, sampler);
+
+                                //发射光线，累加颜色和当前采样点的降噪数据
+                                const PathSample sample = rayColor(cam, sampler, ray, tree, indexArray,
+                                                                   spheres, triangles, parallelograms, transforms, boxes, meshes,
+                                                                   roughMaterials, metalMaterials, lightMaterials, dielectricMaterials,
+                                                                   lightSampler, guidePDFs, guidePDFCount,
+                                                                   hittablePDFSphere, hittablePDFParallelogram);
+                                samples.addSample(sample);
+                                tileRayCount += sample.rayCount;
+                            }
+                            //累加本轮的采样结果
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+                            samples.traversal = threadTraversalCounters() - pixelTraversalStart;
+                            tileTraversal += samples.traversal;
+#endif
+                            tilePrimaryRayCount += passSampleCount;
+                            frameBuffer.accumulatePixel(i, j, samples);
+                            if (isPixelActive(i, j)) {
+                                tileActivePixelCount++;
+                            }
+                        }
+                    }
+                    isTileActive[tileIndex] = tileActivePixelCount > 0;
+                    activePixelCount += tileActivePixelCount;
+                    primaryRayCount += tilePrimaryRayCount;
+                    totalRayCount += tileRayCount;
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+                    {
+                        std::lock_guard<std::mutex> lock(traversalMutex);
+                        traversalTotal += tileTraversal;
                     }
-                }
 #endif
-                result *= cam.reciprocalSqrtSampleCount * cam.reciprocalSqrtSampleCount;
 
-                //写入颜色
-                result.writeColor(pixels + (i * cam.windowWidth + j), format);
+                    if (viewer != nullptr) {
+                        std::lock_guard<std::mutex> lock(finishedTileMutex);
+                        finishedTiles.push_back(tileIndex);
+                    }
+                    finishedTileCount++;
+                });
+            }
 
-                //将降噪数据写入全局缓冲区
-                albedo *= cam.reciprocalSqrtSampleCount * cam.reciprocalSqrtSampleCount;
-                normal.unitize();
+            //主线程不参与像素计算，只负责输出进度，有预览窗口时处理窗口事件并显示已完成的图块，直到本轮所有图块渲染完成
+            while (!pool.waitFor(100)) {
+                if (viewer != nullptr) {
+                    if (!viewer->pollEvents()) { exit(1); }
+                    displayFinishedTiles();
+                }
 
-                const size_t pixelIndex = (i * cam.windowWidth + j) * 3;
-                for (int k = 0; k < 3; k++) {
-                    cam.denoiser.colorPtr[pixelIndex + k] = static_cast<float>(result[k]);
-                    cam.denoiser.albedoPtr[pixelIndex + k] = static_cast<float>(albedo[k]);
-                    cam.denoiser.normalPtr[pixelIndex + k] = static_cast<float>(normal[k]);
+                const auto rate = static_cast<Uint32>(finishedTileCount * 100 / activeTiles.size());
+                if (rate != lastRate) {
+                    lastRate = rate;
+                    SDL_Log("Rendered %u%%", rate);
                 }
             }
+            if (viewer != nullptr) {
+                displayFinishedTiles();
+            }
+
+            if (samplesPerPass < maxSampleCount) {
+                SDL_Log("Pass %u completed. Active pixels: %llu, Time: %u ms",
+                        passIndex + 1, static_cast<unsigned long long>(activePixelCount.load()), SDL_GetTicks() - startTick);
+            }
+        }
 
-#ifdef REFRESH_ON_RENDER
-            const auto rate = static_cast<Uint32>(i * 100 / cam.windowHeight);
-            if (rate / refreshRate != lastRate) {
-                lastRate = rate / refreshRate;
-                SDL_Log("Rendered %u%%", rate);
-                SDL_UpdateWindowSurface(window);
+        //统计采样数，自适应采样时各像素的采样数不同
+        if (samplesPerPass < maxSampleCount) {
+            Uint64 totalSampleCount = 0;
+            for (const Uint32 count : frameBuffer.sampleCounts) {
+                totalSampleCount += count;
             }
+            SDL_Log("Average samples per pixel: %.2lf / %u",
+                    static_cast<double>(totalSampleCount) / static_cast<double>(frameBuffer.pixelCount()), maxSampleCount);
+        }
+
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+        //全局遍历统计，平均值按相机光路数计算
+        {
+            const double pathCount = static_cast<double>(std::max<Uint64>(traversalTotal.pathCount, 1));
+            const auto & tests = traversalTotal.primitiveTestCounts;
+            SDL_Log("Traversal statistics: Paths: %llu, Nodes/Path: %.2lf, Primitive Tests/Path: %.2lf, "
+                    "Bounces/Path: %.2lf, Shadow Rays/Path: %.2lf",
+                    static_cast<unsigned long long>(traversalTotal.pathCount), traversalTotal.nodeCount / pathCount,
+                    traversalTotal.primitiveTestCount() / pathCount, traversalTotal.bounceCount / pathCount,
+                    traversalTotal.shadowRayCount / pathCount);
+            SDL_Log("Primitive tests: Sphere: %llu, Triangle: %llu, Parallelogram: %llu, Transform: %llu, Box: %llu, Mesh: %llu, Mesh Triangle: %llu",
+                    static_cast<unsigned long long>(tests[static_cast<size_t>(PrimitiveType::SPHERE)]),
+                    static_cast<unsigned long long>(tests[static_cast<size_t>(PrimitiveType::TRIANGLE)]),
+                    static_cast<unsigned long long>(tests[static_cast<size_t>(PrimitiveType::PARALLELOGRAM)]),
+                    static_cast<unsigned long long>(tests[static_cast<size_t>(PrimitiveType::TRANSFORM)]),
+                    static_cast<unsigned long long>(tests[static_cast<size_t>(PrimitiveType::BOX)]),
+                    static_cast<unsigned long long>(tests[static_cast<size_t>(PrimitiveType::MESH)]),
+                    static_cast<unsigned long long>(traversalTotal.meshTriangleTestCount));
+        }
 #endif
+
+        //采样时间不包括渐进式渲染过程中的预览降噪
+        const Uint32 sampleTime = SDL_GetTicks() - startTick - denoiseTime;
+
+        //降噪，结果写回帧缓冲区
+        denoise();
+        if (viewer != nullptr) {
+            viewer->writeFrame(frameBuffer);
         }
 
-        //降噪并显示
-        cam.denoiser.denoiseAndWrite(pixels, format);
+        if (statistics != nullptr) {
+            statistics->bvhBuildTime = bvhBuildTime;
+            statistics->sampleTime = sampleTime;
+            statistics->denoiseTime = denoiseTime;
+            statistics->passCount = passIndex;
+            statistics->primaryRayCount = primaryRayCount;
+            statistics->secondaryRayCount = totalRayCount - primaryRayCount;
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+            statistics->traversal = traversalTotal;
+#endif
+        }
         return SDL_GetTicks() - startTick;
     }
 }
\ No newline at end of file
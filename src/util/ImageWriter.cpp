@@ -0,0 +1,217 @@
+#include <util/ImageWriter.hpp>
+
+#include <cstdio>
+
+namespace renderer {
+    namespace {
+        typedef std::unique_ptr<FILE, int (*)(FILE *)> FilePointer;
+
+        FilePointer openFile(const std::string & path) {
+            FilePointer file(fopen(path.c_str(), "wb"), fclose);
+            if (file == nullptr) {
+                throw std::runtime_error("Cannot open file: " + path);
+            }
+            return file;
+        }
+
+        void writeBytes(FILE * file, const void * data, size_t size, const std::string & path) {
+            if (fwrite(data, 1, size, file) != size) {
+                throw std::runtime_error("Cannot write file: " + path);
+            }
+        }
+
+        // ====== OpenEXR头部 ======
+
+        //EXR文件中的所有数值均为小端序
+        void appendUint32(std::vector<char> & header, Uint32 value) {
+            value = SDL_SwapLE32(value);
+            const auto * bytes = reinterpret_cast<const char *>(&value);
+            header.insert(header.end(), bytes, bytes + sizeof(value));
+        }
+
+        void appendFloat(std::vector<char> & header, float value) {
+            value = SDL_SwapFloatLE(value);
+            const auto * bytes = reinterpret_cast<const char *>(&value);
+            header.insert(header.end(), bytes, bytes + sizeof(value));
+        }
+
+        //字符串以'\0'结尾
+        void appendString(std::vector<char> & header, const char * value) {
+            header.insert(header.end(), value, value + strlen(value) + 1);
+        }
+
+        //属性：名称、类型、值的字节数、值
+        void appendAttribute(std::vector<char> & header, const char * name, const char * type, const std::vector<char> & value) {
+            appendString(header, name);
+            appendString(header, type);
+            appendUint32(header, static_cast<Uint32>(value.size()));
+            header.insert(header.end(), value.begin(), value.end());
+        }
+
+        //EXR通道：名称和数据来源（帧缓冲区数组、像素内的分量下标和每个像素的分量数）
+        struct ExrChannel {
+            const char * name;
+            const std::vector<float> FrameBuffer::* buffer;
+            int component;
+            int stride;
+        };
+
+        //通道必须按名称的字节序排列，扫描线中各通道的数据也按此顺序存放
+        const ExrChannel EXR_CHANNELS[] = {
+                {"B", &FrameBuffer::color, 2, 3},
+                {"G", &FrameBuffer::color, 1, 3},
+                {"R", &FrameBuffer::color, 0, 3},
+                {"albedo.B", &FrameBuffer::albedo, 2, 3},
+                {"albedo.G", &FrameBuffer::albedo, 1, 3},
+                {"albedo.R", &FrameBuffer::albedo, 0, 3},
+                {"normal.X", &FrameBuffer::normal, 0, 3},
+                {"normal.Y", &FrameBuffer::normal, 1, 3},
+                {"normal.Z", &FrameBuffer::normal, 2, 3}
+#ifdef RENDERER_TRAVERSAL_STATISTICS
+                ,
+                {"traversal.bounces", &FrameBuffer::traversalHeatmap, 2, FrameBuffer::HEATMAP_CHANNEL_COUNT},
+                {"traversal.nodes", &FrameBuffer::traversalHeatmap, 0, FrameBuffer::HEATMAP_CHANNEL_COUNT},
+                {"traversal.primitives", &FrameBuffer::traversalHeatmap, 1, FrameBuffer::HEATMAP_CHANNEL_COUNT},
+                {"traversal.shadowRays", &FrameBuffer::traversalHeatmap, 3, FrameBuffer::HEATMAP_CHANNEL_COUNT}
+#endif
+        };
+        constexpr size_t EXR_CHANNEL_COUNT = sizeof(EXR_CHANNELS) / sizeof(EXR_CHANNELS[0]);
+
+        std::vector<char> constructExrHeader(Uint32 width, Uint32 height) {
+            std::vector<char> header;
+
+            //魔数和版本号（版本2，单部分扫描线文件）
+            appendUint32(header, 20000630);
+            appendUint32(header, 2);
+
+            std::vector<char> value;
+            for (const auto & channel : EXR_CHANNELS) {
+                appendString(value, channel.name);
+                appendUint32(value, 2); //像素类型：FLOAT
+                value.insert(value.end(), 4, 0); //pLinear和3个保留字节
+                appendUint32(value, 1); //x方向采样间隔
+                appendUint32(value, 1); //y方向采样间隔
+            }
+            value.push_back(0);
+            appendAttribute(header, "channels", "chlist", value);
+
+            appendAttribute(header, "compression", "compression", std::vector<char>(1, 0)); //NO_COMPRESSION
+
+            value.clear();
+            appendUint32(value, 0);
+            appendUint32(value, 0);
+            appendUint32(value, width - 1);
+            appendUint32(value, height - 1);
+            appendAttribute(header, "dataWindow", "box2i", value);
+            appendAttribute(header, "displayWindow", "box2i", value);
+
+            appendAttribute(header, "lineOrder", "lineOrder", std::vector<char>(1, 0)); //INCREASING_Y
+
+            value.clear();
+            appendFloat(value, 1.0f);
+            appendAttribute(header, "pixelAspectRatio", "float", value);
+
+            value.clear();
+            appendFloat(value, 0.0f);
+            appendFloat(value, 0.0f);
+            appendAttribute(header, "screenWindowCenter", "v2f", value);
+
+            value.clear();
+            appendFloat(value, 1.0f);
+            appendAttribute(header, "screenWindowWidth", "float", value);
+
+            header.push_back(0);
+            return header;
+        }
+
+        std::string lowerCaseExtension(const std::string & path) {
+            const size_t dotIndex = path.find_last_of('.');
+            if (dotIndex == std::string::npos || path.find_first_of("/\\", dotIndex) != std::string::npos) {
+                return "";
+            }
+            std::string ret = path.substr(dotIndex);
+            std::transform(ret.begin(), ret.end(), ret.begin(), [](char c) { return static_cast<char>(tolower(c)); });
+            return ret;
+        }
+    }
+
+    void ImageWriter::save(const FrameBuffer & frameBuffer, const std::string & path) {
+        const std::string extension = lowerCaseExtension(path);
+        if (extension == ".png") {
+            savePNG(frameBuffer, path);
+        } else if (extension == ".pfm") {
+            savePFM(frameBuffer, path);
+        } else if (extension == ".exr") {
+            saveEXR(frameBuffer, path);
+        } else {
+            throw std::runtime_error("Unsupported image format: " + path);
+        }
+    }
+
+    void ImageWriter::savePNG(const FrameBuffer & frameBuffer, const std::string & path) {
+        std::unique_ptr<SDL_Surface, void (*)(SDL_Surface *)> surface(
+                SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(frameBuffer.width), static_cast<int>(frameBuffer.height),
+                                               32, SDL_PIXELFORMAT_ARGB8888),
+                SDL_FreeSurface);
+        if (surface == nullptr) {
+            throw std::runtime_error(std::string("Cannot create surface: ") + SDL_GetError());
+        }
+
+        frameBuffer.writePixels(static_cast<Uint32 *>(surface->pixels), surface->format);
+        if (IMG_SavePNG(surface.get(), path.c_str()) < 0) {
+            throw std::runtime_error("Cannot save image: " + path + ", " + IMG_GetError());
+        }
+    }
+
+    void ImageWriter::savePFM(const FrameBuffer & frameBuffer, const std::string & path) {
+        const FilePointer file = openFile(path);
+
+        //比例因子的符号表示字节序，负数为小端序，数据按本机字节序直接写入
+        char header[64];
+        const int headerLength = snprintf(header, sizeof(header), "PF\n%u %u\n%s\n",
+                                          frameBuffer.width, frameBuffer.height,
+                                          SDL_BYTEORDER == SDL_LIL_ENDIAN ? "-1.0" : "1.0");
+        writeBytes(file.get(), header, static_cast<size_t>(headerLength), path);
+
+        //PFM的扫描线从下到上排列，帧缓冲区的一行即为一条RGB交错的扫描线
+        const size_t lineSize = static_cast<size_t>(frameBuffer.width) * 3 * sizeof(float);
+        for (Uint32 i = frameBuffer.height; i > 0; i--) {
+            writeBytes(file.get(), frameBuffer.color.data() + frameBuffer.pixelIndex(i - 1, 0), lineSize, path);
+        }
+    }
+
+    void ImageWriter::saveEXR(const FrameBuffer & frameBuffer, const std::string & path) {
+        const FilePointer file = openFile(path);
+        const Uint32 width = frameBuffer.width;
+        const Uint32 height = frameBuffer.height;
+
+        const std::vector<char> header = constructExrHeader(width, height);
+        writeBytes(file.get(), header.data(), header.size(), path);
+
+        //偏移表：无压缩时每个数据块为一条扫描线，块由行号、数据字节数和各通道数据组成
+        const Uint32 lineDataSize = static_cast<Uint32>(EXR_CHANNEL_COUNT * width * sizeof(float));
+        const Uint64 firstChunkOffset = header.size() + static_cast<Uint64>(height) * sizeof(Uint64);
+        std::vector<Uint64> offsets(height);
+        for (Uint32 i = 0; i < height; i++) {
+            offsets[i] = SDL_SwapLE64(firstChunkOffset + static_cast<Uint64>(i) * (2 * sizeof(Uint32) + lineDataSize));
+        }
+        writeBytes(file.get(), offsets.data(), offsets.size() * sizeof(Uint64), path);
+
+        //逐行将交错存储的像素分量拆分为平面通道，只需要一条扫描线的缓冲区
+        std::vector<float> line(EXR_CHANNEL_COUNT * width);
+        for (Uint32 i = 0; i < height; i++) {
+            for (size_t c = 0; c < EXR_CHANNEL_COUNT; c++) {
+                const ExrChannel & channel = EXR_CHANNELS[c];
+                const float * source = (frameBuffer.*channel.buffer).data() + static_cast<size_t>(i) * width * channel.stride + channel.component;
+                float * target = line.data() + c * width;
+                for (Uint32 j = 0; j < width; j++) {
+                    target[j] = SDL_SwapFloatLE(source[static_cast<size_t>(channel.stride) * j]);
+                }
+            }
+
+            const Uint32 chunkHeader[] = {SDL_SwapLE32(i), SDL_SwapLE32(lineDataSize)};
+            writeBytes(file.get(), chunkHeader, sizeof(chunkHeader), path);
+            writeBytes(file.get(), line.data(), line.size() * sizeof(float), path);
+        }
+    }
+}
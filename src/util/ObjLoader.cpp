@@ -0,0 +1,458 @@
+#include <util/ObjLoader.hpp>
+
+#include <cstdio>
+#include <unordered_map>
+
+namespace renderer {
+    namespace {
+        //每次从文件读入的字节数，单行长度超过缓冲区时缓冲区自动扩大
+        constexpr size_t READ_CHUNK_SIZE = 1 << 22;
+
+        //10的整数次幂，不超过10^22的幂可以用double精确表示
+        constexpr double POWERS_OF_TEN[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        /*
+         * 按块读取文件并逐行调用function(行首, 行尾, 行号)，行尾不包含换行符
+         * 一块的末尾不完整的行移动到缓冲区开头，与下一块拼接
+         */
+        template<typename LineFunction>
+        void readLines(const std::string & path, LineFunction & function) {
+            std::unique_ptr<FILE, int (*)(FILE *)> file(fopen(path.c_str(), "rb"), fclose);
+            if (file == nullptr) {
+                throw std::runtime_error("Cannot open file: " + path);
+            }
+
+            std::vector<char> buffer(READ_CHUNK_SIZE);
+            size_t carryCount = 0; //上一块末尾未处理的字节数
+            size_t lineNumber = 0;
+            while (true) {
+                if (carryCount == buffer.size()) {
+                    buffer.resize(buffer.size() * 2);
+                }
+                const size_t readCount = fread(buffer.data() + carryCount, 1, buffer.size() - carryCount, file.get());
+                const char * lineStart = buffer.data();
+                const char * end = buffer.data() + carryCount + readCount;
+
+                const char * newline;
+                while ((newline = static_cast<const char *>(memchr(lineStart, '\n', end - lineStart))) != nullptr) {
+                    function(lineStart, newline, ++lineNumber);
+                    lineStart = newline + 1;
+                }
+
+                carryCount = end - lineStart;
+                if (readCount == 0) {
+                    //文件结束，最后一行可能没有换行符
+                    if (carryCount > 0) {
+                        function(lineStart, end, ++lineNumber);
+                    }
+                    break;
+                }
+                memmove(buffer.data(), lineStart, carryCount);
+            }
+        }
+
+        bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        const char * skipSpaces(const char * p, const char * end) {
+            while (p < end && isSpace(*p)) p++;
+            return p;
+        }
+
+        //读取一个以空白分隔的单词
+        const char * skipWord(const char * p, const char * end) {
+            while (p < end && !isSpace(*p)) p++;
+            return p;
+        }
+
+        bool wordEquals(const char * begin, const char * end, const char * word) {
+            const size_t length = strlen(word);
+            return static_cast<size_t>(end - begin) == length && memcmp(begin, word, length) == 0;
+        }
+
+        //行中剩余部分去掉首尾空白，用于材质名和文件名
+        std::string restOfLine(const char * p, const char * end) {
+            p = skipSpaces(p, end);
+            while (end > p && isSpace(*(end - 1))) end--;
+            return {p, end};
+        }
+
+        [[noreturn]] void throwParseError(const std::string & path, size_t lineNumber, const char * message) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + message);
+        }
+
+        //解析连续的count个浮点数，不足count个时剩余分量使用defaultValue
+        size_t parseFloats(const char * p, const char * end, float * values, size_t count, float defaultValue) {
+            size_t parsedCount = 0;
+            for (; parsedCount < count; parsedCount++) {
+                p = skipSpaces(p, end);
+                double value;
+                if (!ObjLoader::parseDouble(p, end, value)) break;
+                values[parsedCount] = static_cast<float>(value);
+            }
+            for (size_t i = parsedCount; i < count; i++) {
+                values[i] = defaultValue;
+            }
+            return parsedCount;
+        }
+
+        //MTL材质中用到的属性
+        struct MtlMaterial {
+            Color3 diffuse {0.8, 0.8, 0.8};
+            Color3 emission;
+        };
+
+        std::unordered_map<std::string, MtlMaterial> loadMtl(const std::string & path) {
+            std::unordered_map<std::string, MtlMaterial> ret;
+            MtlMaterial * current = nullptr;
+
+            auto lineFunction = [&](const char * p, const char * end, size_t lineNumber) {
+                p = skipSpaces(p, end);
+                const char * keywordEnd = skipWord(p, end);
+                if (wordEquals(p, keywordEnd, "newmtl")) {
+                    current = &ret[restOfLine(keywordEnd, end)];
+                } else if (wordEquals(p, keywordEnd, "Kd") || wordEquals(p, keywordEnd, "Ke")) {
+                    if (current == nullptr) {
+                        throwParseError(path, lineNumber, "Material property before newmtl");
+                    }
+                    float values[3];
+                    if (parseFloats(keywordEnd, end, values, 3, 0.0f) == 0) {
+                        throwParseError(path, lineNumber, "Invalid color");
+                    }
+                    (p[1] == 'd' ? current->diffuse : current->emission) = Color3(values[0], values[1], values[2]);
+                }
+            };
+            readLines(path, lineFunction);
+            return ret;
+        }
+
+        //OBJ顶点的位置、纹理坐标和法向量下标，下标从0开始，没有纹理坐标或法向量时为NONE
+        constexpr Uint32 NONE = std::numeric_limits<Uint32>::max();
+
+        struct VertexKey {
+            Uint32 position;
+            Uint32 uv;
+            Uint32 normal;
+
+            bool operator==(const VertexKey & obj) const {
+                return position == obj.position && uv == obj.uv && normal == obj.normal;
+            }
+        };
+
+        struct VertexKeyHash {
+            size_t operator()(const VertexKey & key) const {
+                return static_cast<size_t>(mixBits((static_cast<Uint64>(key.position) << 32 | key.uv) ^ mixBits(key.normal)));
+            }
+        };
+
+        /*
+         * 一个材质分组的构建状态
+         * 大多数OBJ中每个位置只对应一种纹理坐标和法向量组合，先按位置下标查找该位置第一次出现时生成的顶点，
+         * 组合相同时直接复用，不同时才使用哈希表查找
+         */
+        struct GroupBuilder {
+            size_t meshDataIndex;
+
+            std::vector<Uint32> positionRemap; //位置下标到该位置第一次出现时生成的分组顶点下标
+            std::vector<VertexKey> vertexKeys; //分组顶点对应的OBJ下标组合
+            std::unordered_map<VertexKey, Uint32, VertexKeyHash> vertexMap;
+
+            bool hasAllNormals = true;
+            bool hasAllUVs = true;
+        };
+    }
+
+    bool ObjLoader::parseDouble(const char * & p, const char * end, double & value) {
+        const char * current = p;
+        bool isNegative = false;
+        if (current < end && (*current == '-' || *current == '+')) {
+            isNegative = *current == '-';
+            current++;
+        }
+
+        //尾数最多保留19位有效数字，超出部分只计入指数
+        Uint64 mantissa = 0;
+        int digitCount = 0;
+        int exponent = 0;
+        bool hasDigits = false;
+        for (; current < end && *current >= '0' && *current <= '9'; current++) {
+            hasDigits = true;
+            if (digitCount < 19) {
+                mantissa = mantissa * 10 + (*current - '0');
+                if (mantissa > 0) digitCount++;
+            } else {
+                exponent++;
+            }
+        }
+        if (current < end && *current == '.') {
+            current++;
+            for (; current < end && *current >= '0' && *current <= '9'; current++) {
+                hasDigits = true;
+                if (digitCount < 19) {
+                    mantissa = mantissa * 10 + (*current - '0');
+                    if (mantissa > 0) digitCount++;
+                    exponent--;
+                }
+            }
+        }
+        if (!hasDigits) {
+            return false;
+        }
+
+        if (current < end && (*current == 'e' || *current == 'E')) {
+            const char * exponentStart = current + 1;
+            long long exponentValue;
+            if (parseInteger(exponentStart, end, exponentValue)) {
+                exponent += static_cast<int>(std::max(-1000LL, std::min(1000LL, exponentValue)));
+                current = exponentStart;
+            }
+        }
+
+        //尾数不超过2^53（转换为double没有舍入）且指数绝对值不超过22时，一次乘除法即可得到正确舍入的结果
+        auto result = static_cast<double>(mantissa);
+        const bool isExactMantissa = mantissa <= (1ULL << 53);
+        if (isExactMantissa && exponent >= 0 && exponent <= 22) {
+            result *= POWERS_OF_TEN[exponent];
+        } else if (isExactMantissa && exponent < 0 && exponent >= -22) {
+            result /= POWERS_OF_TEN[-exponent];
+        } else {
+            //其他情况结果可能有1ulp的误差，对模型数据足够
+            result *= std::pow(10.0, exponent);
+        }
+        value = isNegative ? -result : result;
+        p = current;
+        return true;
+    }
+
+    bool ObjLoader::parseInteger(const char * & p, const char * end, long long & value) {
+        const char * current = p;
+        bool isNegative = false;
+        if (current < end && (*current == '-' || *current == '+')) {
+            isNegative = *current == '-';
+            current++;
+        }
+        if (current == end || *current < '0' || *current > '9') {
+            return false;
+        }
+
+        long long result = 0;
+        for (; current < end && *current >= '0' && *current <= '9'; current++) {
+            if (result < (std::numeric_limits<long long>::max() - 9) / 10) {
+                result = result * 10 + (*current - '0');
+            }
+        }
+        value = isNegative ? -result : result;
+        p = current;
+        return true;
+    }
+
+    ObjModel ObjLoader::load(const std::string & path, const ObjLoadOptions & options) {
+        ObjModel model;
+
+        //文件中的全部顶点属性，面通过下标引用
+        std::vector<float> positions;
+        std::vector<float> uvs;
+        std::vector<float> normals;
+
+        //按材质名分组，同一材质在文件中多次出现时合并到同一分组
+        std::vector<GroupBuilder> groups;
+        std::unordered_map<std::string, size_t> groupIndices;
+        GroupBuilder * currentGroup = nullptr;
+        std::unordered_map<std::string, MtlMaterial> materials;
+
+        auto selectGroup = [&](const std::string & materialName) {
+            auto iterator = groupIndices.find(materialName);
+            if (iterator == groupIndices.end()) {
+                iterator = groupIndices.emplace(materialName, groups.size()).first;
+                groups.emplace_back();
+                groups.back().meshDataIndex = model.meshData.size();
+                model.meshData.emplace_back();
+                model.meshData.back().materialName = materialName;
+            }
+            currentGroup = &groups[iterator->second];
+        };
+
+        //将OBJ下标转换为从0开始的下标，负数下标为相对于当前已定义元素的末尾
+        auto resolveIndex = [&](long long index, size_t count, size_t lineNumber) -> Uint32 {
+            const long long ret = index < 0 ? static_cast<long long>(count) + index : index - 1;
+            if (ret < 0 || ret >= static_cast<long long>(count)) {
+                throwParseError(path, lineNumber, "Face index out of range");
+            }
+            return static_cast<Uint32>(ret);
+        };
+
+        //取得面中一个顶点在当前分组中的下标，新顶点追加到分组的顶点数组
+        auto groupVertex = [&](const VertexKey & key) -> Uint32 {
+            ObjModel::MeshData & data = model.meshData[currentGroup->meshDataIndex];
+            const auto newIndex = static_cast<Uint32>(data.positions.size() / 3);
+
+            auto & remap = currentGroup->positionRemap;
+            if (remap.size() <= key.position) {
+                remap.resize(positions.size() / 3, NONE);
+            }
+            const Uint32 firstIndex = remap[key.position];
+            if (firstIndex == NONE) {
+                remap[key.position] = newIndex;
+            } else if (currentGroup->vertexKeys[firstIndex] == key) {
+                return firstIndex;
+            } else {
+                const auto result = currentGroup->vertexMap.emplace(key, newIndex);
+                if (!result.second) {
+                    return result.first->second;
+                }
+            }
+            if (newIndex == NONE) {
+                throw std::runtime_error("Too many vertices in OBJ mesh: " + path);
+            }
+
+            currentGroup->vertexKeys.push_back(key);
+            data.positions.insert(data.positions.end(), positions.begin() + 3 * key.position, positions.begin() + 3 * key.position + 3);
+            if (key.uv != NONE) {
+                data.uvs.insert(data.uvs.end(), uvs.begin() + 2 * key.uv, uvs.begin() + 2 * key.uv + 2);
+            } else {
+                currentGroup->hasAllUVs = false;
+                data.uvs.insert(data.uvs.end(), 2, 0.0f);
+            }
+            if (key.normal != NONE) {
+                data.normals.insert(data.normals.end(), normals.begin() + 3 * key.normal, normals.begin() + 3 * key.normal + 3);
+            } else {
+                currentGroup->hasAllNormals = false;
+                data.normals.insert(data.normals.end(), 3, 0.0f);
+            }
+            return newIndex;
+        };
+
+        std::vector<Uint32> faceVertices;
+        auto lineFunction = [&](const char * p, const char * end, size_t lineNumber) {
+            p = skipSpaces(p, end);
+            if (p == end || *p == '#') {
+                return;
+            }
+            const char * keywordEnd = skipWord(p, end);
+
+            if (wordEquals(p, keywordEnd, "v")) {
+                float values[3];
+                if (parseFloats(keywordEnd, end, values, 3, 0.0f) < 3) {
+                    throwParseError(path, lineNumber, "Invalid vertex position");
+                }
+                positions.insert(positions.end(), values, values + 3);
+            } else if (wordEquals(p, keywordEnd, "vt")) {
+                float values[2];
+                if (parseFloats(keywordEnd, end, values, 2, 0.0f) == 0) {
+                    throwParseError(path, lineNumber, "Invalid texture coordinate");
+                }
+                uvs.insert(uvs.end(), values, values + 2);
+            } else if (wordEquals(p, keywordEnd, "vn")) {
+                float values[3];
+                if (parseFloats(keywordEnd, end, values, 3, 0.0f) < 3) {
+                    throwParseError(path, lineNumber, "Invalid vertex normal");
+                }
+                normals.insert(normals.end(), values, values + 3);
+            } else if (wordEquals(p, keywordEnd, "f")) {
+                if (currentGroup == nullptr) {
+                    selectGroup(""); //usemtl之前的面使用默认材质
+                }
+
+                //顶点格式：v、v/vt、v//vn、v/vt/vn
+                faceVertices.clear();
+                const char * current = skipSpaces(keywordEnd, end);
+                while (current < end) {
+                    VertexKey key {NONE, NONE, NONE};
+                    long long index;
+                    if (!parseInteger(current, end, index)) {
+                        throwParseError(path, lineNumber, "Invalid face vertex");
+                    }
+                    key.position = resolveIndex(index, positions.size() / 3, lineNumber);
+                    if (current < end && *current == '/') {
+                        current++;
+                        if (current < end && *current != '/') {
+                            if (!parseInteger(current, end, index)) {
+                                throwParseError(path, lineNumber, "Invalid face texture coordinate");
+                            }
+                            key.uv = resolveIndex(index, uvs.size() / 2, lineNumber);
+                        }
+                        if (current < end && *current == '/') {
+                            current++;
+                            if (!parseInteger(current, end, index)) {
+                                throwParseError(path, lineNumber, "Invalid face normal");
+                            }
+                            key.normal = resolveIndex(index, normals.size() / 3, lineNumber);
+                        }
+                    }
+                    faceVertices.push_back(groupVertex(key));
+                    current = skipSpaces(current, end);
+                }
+                if (faceVertices.size() < 3) {
+                    throwParseError(path, lineNumber, "Face has less than 3 vertices");
+                }
+
+                //多边形按扇形三角化
+                auto & indices = model.meshData[currentGroup->meshDataIndex].indices;
+                for (size_t i = 1; i + 1 < faceVertices.size(); i++) {
+                    indices.push_back(faceVertices[0]);
+                    indices.push_back(faceVertices[i]);
+                    indices.push_back(faceVertices[i + 1]);
+                }
+            } else if (wordEquals(p, keywordEnd, "usemtl")) {
+                selectGroup(restOfLine(keywordEnd, end));
+            } else if (wordEquals(p, keywordEnd, "mtllib")) {
+                //mtllib路径相对于OBJ文件所在目录
+                const size_t slash = path.find_last_of("/\\");
+                const std::string directory = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+                for (auto & pair : loadMtl(directory + restOfLine(keywordEnd, end))) {
+                    materials[pair.first] = pair.second;
+                }
+            }
+            //o、g、s等其他语句不影响几何数据，直接忽略
+        };
+        readLines(path, lineFunction);
+
+        //去掉不完整的法向量和纹理坐标，去掉没有面的分组，为每个分组分配材质
+        std::vector<ObjModel::MeshData> meshData;
+        for (auto & group : groups) {
+            ObjModel::MeshData & data = model.meshData[group.meshDataIndex];
+            if (data.indices.empty()) {
+                continue;
+            }
+            if (!group.hasAllNormals) {
+                std::vector<float>().swap(data.normals);
+            }
+            if (!group.hasAllUVs) {
+                std::vector<float>().swap(data.uvs);
+            }
+            meshData.push_back(std::move(data));
+        }
+        model.meshData = std::move(meshData);
+
+        for (const auto & data : model.meshData) {
+            const auto material = materials.find(data.materialName);
+            const MtlMaterial mtl = material != materials.end() ? material->second : MtlMaterial();
+
+            MaterialType materialType;
+            size_t materialIndex;
+            if (mtl.emission[0] > 0.0 || mtl.emission[1] > 0.0 || mtl.emission[2] > 0.0) {
+                materialType = MaterialType::DIFFUSE_LIGHT;
+                materialIndex = options.lightMaterialOffset + model.lightMaterials.size();
+                model.lightMaterials.emplace_back(mtl.emission);
+            } else {
+                materialType = MaterialType::ROUGH;
+                materialIndex = options.roughMaterialOffset + model.roughMaterials.size();
+                model.roughMaterials.emplace_back(mtl.diffuse);
+            }
+
+            model.meshes.emplace_back(materialType, materialIndex,
+                                      data.positions.data(), static_cast<Uint32>(data.positions.size() / 3),
+                                      data.indices.data(), static_cast<Uint32>(data.indices.size() / 3),
+                                      data.normals.empty() ? nullptr : data.normals.data(),
+                                      data.uvs.empty() ? nullptr : data.uvs.data());
+        }
+
+        //构建并绑定每个网格的内部BVH
+        model.meshBVHs = BVHTree::constructMeshBVH(model.meshes, options.bvhOptions);
+        return model;
+    }
+}